@@ -0,0 +1,115 @@
+// Compares the anonymous pipe audio transport against the old /tmp FIFO.
+// The writer side mimics mpv's "pcm" AO (fopen + fwrite of 4 KiB blocks),
+// the reader side mimics audio_thread_func (non-blocking 4 KiB reads).
+//
+// Usage: mpv-audio-transport-bench [megabytes] [runs]
+
+#include "mpv-audio-pipe.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using bench_clock = std::chrono::steady_clock;
+
+struct RunResult {
+	double setup_us;
+	double mb_per_s;
+};
+
+static void write_stream(const std::string &path, size_t total_bytes) {
+	FILE *f = fopen(path.c_str(), "wb");
+	if (!f) return;
+	std::vector<char> block(4096, 0x2a);
+	for (size_t written = 0; written < total_bytes; written += block.size())
+		fwrite(block.data(), 1, block.size(), f);
+	fclose(f);
+}
+
+template<typename ReadFn> static double read_stream(ReadFn &&read_fn, size_t total_bytes) {
+	std::vector<char> buf(4096);
+	size_t received = 0;
+	auto start = bench_clock::now();
+	while (received < total_bytes) {
+		int64_t n = read_fn(buf.data(), buf.size());
+		if (n > 0) received += (size_t)n;
+		else if (n < 0) break;
+		else std::this_thread::yield();
+	}
+	double secs = std::chrono::duration<double>(bench_clock::now() - start).count();
+	return (double)received / (1024.0 * 1024.0) / secs;
+}
+
+static RunResult run_fifo(size_t total_bytes) {
+	char path[256];
+	snprintf(path, sizeof(path), "/tmp/obs_mpv_audio_bench_%d", (int)getpid());
+
+	auto setup_start = bench_clock::now();
+	mkfifo(path, 0666);
+	int fd = open(path, O_RDONLY | O_NONBLOCK);
+	int retries = 50;
+	while (fd < 0 && retries-- > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		fd = open(path, O_RDONLY | O_NONBLOCK);
+	}
+	double setup_us = std::chrono::duration<double, std::micro>(bench_clock::now() - setup_start).count();
+
+	std::thread writer(write_stream, std::string(path), total_bytes);
+	double mbps = read_stream(
+		[fd](char *buf, size_t size) -> int64_t {
+			ssize_t n = read(fd, buf, size);
+			return n >= 0 ? (int64_t)n : 0;
+		},
+		total_bytes);
+	writer.join();
+
+	close(fd);
+	unlink(path);
+	return {setup_us, mbps};
+}
+
+static RunResult run_pipe(size_t total_bytes) {
+	auto setup_start = bench_clock::now();
+	MpvAudioPipe pipe;
+	pipe.connect();
+	double setup_us = std::chrono::duration<double, std::micro>(bench_clock::now() - setup_start).count();
+
+	std::thread writer(write_stream, pipe.path(), total_bytes);
+	double mbps = read_stream([&pipe](char *buf, size_t size) { return pipe.read(buf, size); }, total_bytes);
+	writer.join();
+	return {setup_us, mbps};
+}
+
+static RunResult median(std::vector<RunResult> runs) {
+	RunResult r;
+	std::sort(runs.begin(), runs.end(), [](auto &a, auto &b) { return a.setup_us < b.setup_us; });
+	r.setup_us = runs[runs.size() / 2].setup_us;
+	std::sort(runs.begin(), runs.end(), [](auto &a, auto &b) { return a.mb_per_s < b.mb_per_s; });
+	r.mb_per_s = runs[runs.size() / 2].mb_per_s;
+	return r;
+}
+
+int main(int argc, char **argv) {
+	size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 256;
+	int runs = argc > 2 ? std::max(1, atoi(argv[2])) : 5;
+	size_t total_bytes = megabytes * 1024 * 1024;
+
+	std::vector<RunResult> fifo, pipe;
+	for (int i = 0; i < runs; i++) {
+		fifo.push_back(run_fifo(total_bytes));
+		pipe.push_back(run_pipe(total_bytes));
+	}
+
+	RunResult f = median(fifo), p = median(pipe);
+	printf("%-10s %12s %12s\n", "transport", "setup (us)", "MB/s");
+	printf("%-10s %12.1f %12.1f\n", "fifo", f.setup_us, f.mb_per_s);
+	printf("%-10s %12.1f %12.1f\n", "pipe", p.setup_us, p.mb_per_s);
+	return 0;
+}
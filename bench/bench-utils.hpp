@@ -0,0 +1,65 @@
+#pragma once
+
+// Small helpers shared by the benchmark executables.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+static inline double bench_percentile(std::vector<double> v, double p) {
+	if (v.empty()) return 0.0;
+	std::sort(v.begin(), v.end());
+	size_t idx = (size_t)std::min<double>((double)v.size() - 1, std::floor(p / 100.0 * (double)v.size()));
+	return v[idx];
+}
+
+static inline double bench_cpu_seconds() {
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return (double)ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + (double)ru.ru_stime.tv_sec +
+	       ru.ru_stime.tv_usec / 1e6;
+}
+
+// Resident set size in MiB (current on Linux, peak elsewhere).
+static inline double bench_rss_mb() {
+#ifdef __linux__
+	FILE *f = fopen("/proc/self/statm", "r");
+	if (f) {
+		long pages = 0, resident = 0;
+		int n = fscanf(f, "%ld %ld", &pages, &resident);
+		fclose(f);
+		if (n == 2) return (double)resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+	}
+#endif
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+	return (double)ru.ru_maxrss / (1024.0 * 1024.0);
+#else
+	return (double)ru.ru_maxrss / 1024.0;
+#endif
+}
+
+// Results are "key value" lines so runs from different commits can be
+// saved and diffed, or fed back in with --baseline.
+using BenchResults = std::vector<std::pair<std::string, double>>;
+
+static inline void bench_print(FILE *f, const BenchResults &results) {
+	for (const auto &r : results) fprintf(f, "%-28s %.3f\n", r.first.c_str(), r.second);
+}
+
+static inline std::map<std::string, double> bench_load(const char *path) {
+	std::map<std::string, double> out;
+	FILE *f = fopen(path, "r");
+	if (!f) return out;
+	char key[128];
+	double val;
+	while (fscanf(f, "%127s %lf", key, &val) == 2) out[key] = val;
+	fclose(f);
+	return out;
+}
@@ -0,0 +1,255 @@
+// Headless benchmark for the ObsMpvSource render and audio pipeline.
+//
+// Plays a synthetic lavfi source (testsrc2 video + sine audio) through a
+// real ObsMpvSource, driving obs_video_tick at a fixed rate, and reports
+// delivered frames/s, per-frame render latency percentiles, audio delivery
+// jitter and process CPU time.
+//
+// --file plays a real file instead (lavfi frames skip the video decoder), and
+// --sources N runs N sources side by side; with --profile that gives the CPU
+// cost per source of each decoder tuning profile.
+//
+// Usage: mpv-pipeline-bench [--seconds N] [--size WxH] [--fps N] [--tick-hz N]
+//                           [--queue N] [--fps-mode N] [--render-size WxH] [--still]
+//                           [--file PATH] [--sources N] [--profile NAME]
+//                           [--trace FILE] [--verbose]
+
+#include "bench-utils.hpp"
+#include "obs-stubs.hpp"
+#include "obs-mpv-source.hpp"
+#include "mpv-trace.hpp"
+
+#include <util/platform.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchOptions {
+	double seconds = 10.0;
+	int width = 1280;
+	int height = 720;
+	int fps = 30;
+	int tick_hz = 60;
+	int queue = 0;
+	int fps_mode = 0;
+	int render_width = 0; // 0 = native
+	int render_height = 0;
+	bool still = false; // Static picture instead of the moving test pattern
+	const char *file = nullptr;
+	int sources = 1;
+	const char *profile = "default";
+	const char *trace = nullptr;
+	bool verbose = false;
+};
+
+static BenchOptions parse_options(int argc, char **argv) {
+	BenchOptions opt;
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!strcmp(arg, "--seconds") && val) opt.seconds = atof(argv[++i]);
+		else if (!strcmp(arg, "--size") && val) sscanf(argv[++i], "%dx%d", &opt.width, &opt.height);
+		else if (!strcmp(arg, "--fps") && val) opt.fps = atoi(argv[++i]);
+		else if (!strcmp(arg, "--tick-hz") && val) opt.tick_hz = atoi(argv[++i]);
+		else if (!strcmp(arg, "--queue") && val) opt.queue = atoi(argv[++i]);
+		else if (!strcmp(arg, "--fps-mode") && val) opt.fps_mode = atoi(argv[++i]);
+		else if (!strcmp(arg, "--render-size") && val) sscanf(argv[++i], "%dx%d", &opt.render_width, &opt.render_height);
+		else if (!strcmp(arg, "--trace") && val) opt.trace = argv[++i];
+		else if (!strcmp(arg, "--still")) opt.still = true;
+		else if (!strcmp(arg, "--file") && val) opt.file = argv[++i];
+		else if (!strcmp(arg, "--sources") && val) opt.sources = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(arg, "--profile") && val) opt.profile = argv[++i];
+		else if (!strcmp(arg, "--verbose")) opt.verbose = true;
+		else {
+			fprintf(stderr,
+				"usage: %s [--seconds N] [--size WxH] [--fps N] [--tick-hz N]\n"
+				"          [--queue N] [--fps-mode N] [--render-size WxH] [--still] [--file PATH]\n"
+				"          [--sources N] [--profile default|hw-copy|sw|sw-lean] [--trace FILE] [--verbose]\n",
+				argv[0]);
+			exit(1);
+		}
+	}
+	return opt;
+}
+
+// Decoder tuning presets, as they would be set in the source properties
+struct DecoderProfile {
+	const char *name;
+	const char *hwdec;
+	int threads;
+	int demuxer_mb;
+	double readahead;
+	const char *framedrop;
+};
+
+static const DecoderProfile k_profiles[] = {
+	{"default", "auto", 0, 150, 1.0, "vo"},
+	{"hw-copy", "auto-copy", 0, 150, 1.0, "vo"},
+	{"sw", "no", 0, 150, 1.0, "vo"},
+	{"sw-lean", "no", 2, 32, 0.5, "decoder+vo"},
+};
+
+static const DecoderProfile *find_profile(const char *name) {
+	for (const auto &p : k_profiles)
+		if (!strcmp(p.name, name)) return &p;
+	return nullptr;
+}
+
+static std::string lavfi_url(const BenchOptions &opt) {
+	char url[512];
+	snprintf(url, sizeof(url), "av://lavfi:%s=size=%dx%d:rate=%d[out0];sine=frequency=440:sample_rate=48000[out1]",
+		 opt.still ? "color=c=gray" : "testsrc2", opt.width, opt.height, opt.fps);
+	return url;
+}
+
+int main(int argc, char **argv) {
+	BenchOptions opt = parse_options(argc, argv);
+	bench_set_log_level(opt.verbose ? LOG_INFO : LOG_ERROR);
+
+	const DecoderProfile *profile = find_profile(opt.profile);
+	if (!profile) {
+		fprintf(stderr, "unknown profile %s\n", opt.profile);
+		return 1;
+	}
+
+	// Playlist with one item, exactly as the source would load it
+	obs_data_t *settings = bench_source_settings();
+	ObsMpvSource::obs_get_defaults(settings);
+	obs_data_array_t *playlist = obs_data_array_create();
+	obs_data_t *item = obs_data_create();
+	std::string url = opt.file ? opt.file : lavfi_url(opt);
+	obs_data_set_string(item, "path", url.c_str());
+	obs_data_set_string(item, "name", "lavfi");
+	obs_data_set_double(item, "volume", 100.0);
+	obs_data_array_push_back(playlist, item);
+	obs_data_release(item);
+	obs_data_set_array(settings, "playlist", playlist);
+	obs_data_array_release(playlist);
+	obs_data_set_int(settings, "frame_queue", opt.queue);
+	obs_data_set_int(settings, "fps_mode", opt.fps_mode);
+	if (opt.render_width > 0 && opt.render_height > 0) {
+		obs_data_set_int(settings, "render_size", 1);
+		obs_data_set_int(settings, "render_width", opt.render_width);
+		obs_data_set_int(settings, "render_height", opt.render_height);
+	}
+	obs_data_set_string(settings, "hwdec", profile->hwdec);
+	obs_data_set_int(settings, "decoder_threads", profile->threads);
+	obs_data_set_int(settings, "demuxer_max_mb", profile->demuxer_mb);
+	obs_data_set_double(settings, "demuxer_readahead", profile->readahead);
+	obs_data_set_string(settings, "framedrop", profile->framedrop);
+
+	uint64_t frames_out = 0;
+	bool frame_this_tick = false;
+	std::mutex audio_mutex;
+	std::vector<double> audio_lead_ms; // how far ahead of its timestamp each packet arrived
+	std::vector<double> audio_gap_ms;  // wall time between packets
+	uint64_t last_audio_ns = 0;
+
+	bench_hooks().video = [&](const struct obs_source_frame *) {
+		frames_out++;
+		frame_this_tick = true;
+	};
+	bench_hooks().audio = [&](const struct obs_source_audio *audio) {
+		uint64_t now = os_gettime_ns();
+		std::lock_guard<std::mutex> lock(audio_mutex);
+		audio_lead_ms.push_back(((double)audio->timestamp - (double)now) / 1e6);
+		if (last_audio_ns) audio_gap_ms.push_back((double)(now - last_audio_ns) / 1e6);
+		last_audio_ns = now;
+	};
+
+	if (opt.trace) mpv_trace_start();
+
+	// Any distinct pointers do as obs_source_t handles for the stubs
+	std::vector<char> fake_sources((size_t)opt.sources);
+	std::vector<ObsMpvSource *> sources;
+	uint64_t create_start = os_gettime_ns();
+	for (char &fake : fake_sources) {
+		auto *s = static_cast<ObsMpvSource *>(
+			ObsMpvSource::obs_create(settings, reinterpret_cast<obs_source_t *>(&fake)));
+		ObsMpvSource::obs_show(s);
+		ObsMpvSource::obs_activate(s);
+		sources.push_back(s);
+	}
+	double create_ms = (double)(os_gettime_ns() - create_start) / 1e6 / (double)opt.sources;
+	uint64_t play_start = os_gettime_ns();
+	for (auto *s : sources) s->playlist_play(0);
+
+	std::vector<double> render_ms;
+	const auto tick_interval = std::chrono::nanoseconds(1000000000LL / opt.tick_hz);
+	const float tick_seconds = 1.0f / (float)opt.tick_hz;
+
+	double cpu_start = bench_cpu_seconds();
+	auto start = std::chrono::steady_clock::now();
+	auto next_tick = start;
+	uint64_t first_frame_ns = 0;
+	while (std::chrono::steady_clock::now() - start < std::chrono::duration<double>(opt.seconds)) {
+		for (auto *s : sources) {
+			frame_this_tick = false;
+			uint64_t t0 = os_gettime_ns();
+			ObsMpvSource::obs_video_tick(s, tick_seconds);
+			uint64_t t1 = os_gettime_ns();
+			if (frame_this_tick) {
+				render_ms.push_back((double)(t1 - t0) / 1e6);
+				if (!first_frame_ns) first_frame_ns = t1;
+			}
+		}
+
+		next_tick += tick_interval;
+		std::this_thread::sleep_until(next_tick);
+	}
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double cpu = bench_cpu_seconds() - cpu_start;
+
+	ObsMpvSource::Stats stats = sources[0]->get_stats();
+	for (auto *s : sources) ObsMpvSource::obs_destroy(s);
+	if (opt.trace) mpv_trace_dump(opt.trace);
+
+	std::vector<double> lead, gaps;
+	{
+		std::lock_guard<std::mutex> lock(audio_mutex);
+		lead = audio_lead_ms;
+		gaps = audio_gap_ms;
+	}
+	double lead_mean = 0.0, lead_var = 0.0;
+	for (double v : lead) lead_mean += v;
+	if (!lead.empty()) lead_mean /= (double)lead.size();
+	for (double v : lead) lead_var += (v - lead_mean) * (v - lead_mean);
+	double lead_stddev = lead.empty() ? 0.0 : std::sqrt(lead_var / (double)lead.size());
+
+	printf("source            %s\n", url.c_str());
+	printf("sources           %d\n", opt.sources);
+	printf("profile           %s\n", profile->name);
+	printf("hwdec_current     %s\n", stats.hwdec_current.c_str());
+	printf("create_ms         %.1f\n", create_ms);
+	printf("first_frame_ms    %.1f\n", first_frame_ns ? (double)(first_frame_ns - play_start) / 1e6 : -1.0);
+	printf("wall_s            %.2f\n", wall);
+	printf("frames_out        %llu\n", (unsigned long long)frames_out);
+	printf("fps               %.2f\n", frames_out / wall / opt.sources);
+	printf("output_size       %ux%u\n", stats.output_width, stats.output_height);
+	printf("render_ms_p50     %.3f\n", bench_percentile(render_ms, 50));
+	printf("render_ms_p95     %.3f\n", bench_percentile(render_ms, 95));
+	printf("render_ms_p99     %.3f\n", bench_percentile(render_ms, 99));
+	printf("render_ms_max     %.3f\n", bench_percentile(render_ms, 100));
+	printf("frames_dropped    %lld\n", (long long)stats.frames_dropped);
+	printf("frame_queue       %llu\n", (unsigned long long)stats.frame_queue_capacity);
+	printf("frame_spikes      %llu\n", (unsigned long long)stats.frame_spikes);
+	printf("spikes_absorbed   %llu\n", (unsigned long long)stats.spikes_absorbed);
+	printf("frames_unchanged  %llu\n", (unsigned long long)stats.frames_unchanged);
+	printf("audio_packets     %zu\n", lead.size());
+	printf("audio_lead_ms     %.2f\n", lead_mean);
+	printf("audio_jitter_ms   %.3f\n", lead_stddev);
+	printf("audio_gap_ms_p99  %.2f\n", bench_percentile(gaps, 99));
+	printf("audio_underruns   %llu\n", (unsigned long long)stats.audio_underruns);
+	printf("cpu_s             %.2f\n", cpu);
+	printf("cpu_pct           %.1f\n", cpu / wall * 100.0);
+	printf("cpu_pct_per_src   %.1f\n", cpu / wall * 100.0 / opt.sources);
+	return 0;
+}
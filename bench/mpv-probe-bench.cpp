@@ -0,0 +1,353 @@
+// Probe throughput benchmark for playlist loading.
+//
+// Generates a small corpus of local media files with libmpv's encoding mode
+// (several containers, video/audio/both, short and long durations), then
+// measures through a real ObsMpvSource:
+//   - per-file probe latency via playlist_add(), until the pool has probed it
+//   - playlist_add_multiple() over the whole corpus, with the probes spread
+//     over the worker pool
+//   - load_playlist() for N-item playlists, with resident memory deltas: the
+//     call itself, the background probe of items saved without metadata, and
+//     reloading once the metadata has been saved with the playlist
+//   - source creation with such a playlist, as on scene collection load
+//
+// Results are printed as "key value" lines. Save a run with --save and pass
+// it back with --baseline on a later commit to flag regressions.
+//
+// Usage: mpv-probe-bench [--corpus DIR] [--regen] [--repeat N] [--items N,N,...]
+//                        [--save FILE] [--baseline FILE] [--tolerance PCT] [--verbose]
+
+#include "bench-utils.hpp"
+#include "obs-stubs.hpp"
+#include "obs-mpv-source.hpp"
+
+#include <mpv/client.h>
+#include <util/platform.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+struct BenchOptions {
+	std::string corpus = "/tmp/obs-mpv-probe-corpus";
+	bool regen = false;
+	int repeat = 3;
+	std::vector<int> items = {10, 50};
+	const char *save = nullptr;
+	const char *baseline = nullptr;
+	double tolerance = 15.0;
+	bool verbose = false;
+};
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+		"usage: %s [--corpus DIR] [--regen] [--repeat N] [--items N,N,...] [--save FILE]\n"
+		"          [--baseline FILE] [--tolerance PCT] [--verbose]\n",
+		argv0);
+	exit(1);
+}
+
+static BenchOptions parse_options(int argc, char **argv) {
+	BenchOptions opt;
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!strcmp(arg, "--corpus") && val) opt.corpus = argv[++i];
+		else if (!strcmp(arg, "--regen")) opt.regen = true;
+		else if (!strcmp(arg, "--repeat") && val) opt.repeat = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(arg, "--items") && val) {
+			opt.items.clear();
+			for (const char *p = argv[++i]; *p;) {
+				int n = atoi(p);
+				if (n > 0) opt.items.push_back(n);
+				const char *comma = strchr(p, ',');
+				if (!comma) break;
+				p = comma + 1;
+			}
+		} else if (!strcmp(arg, "--save") && val) opt.save = argv[++i];
+		else if (!strcmp(arg, "--baseline") && val) opt.baseline = argv[++i];
+		else if (!strcmp(arg, "--tolerance") && val) opt.tolerance = atof(argv[++i]);
+		else if (!strcmp(arg, "--verbose")) opt.verbose = true;
+		else usage(argv[0]);
+	}
+	return opt;
+}
+
+// One generated file. mpv's encoder writes at most one video and one audio
+// stream, so track layouts vary between video+audio, video only and audio only.
+struct CorpusSpec {
+	const char *name;
+	const char *format; // "of"
+	const char *vcodec; // nullptr = no video stream
+	const char *acodec; // nullptr = no audio stream
+	int seconds;
+};
+
+static const CorpusSpec k_corpus[] = {
+	{"av-short.mkv", "matroska", "mpeg4", "flac", 2},
+	{"av-medium.mkv", "matroska", "mpeg4", "flac", 10},
+	{"av-long.mkv", "matroska", "mpeg4", "flac", 60},
+	{"av-short.mp4", "mp4", "mpeg4", "aac", 2},
+	{"av-medium.mp4", "mp4", "mpeg4", "aac", 10},
+	{"av-short.mov", "mov", "mpeg4", "pcm_s16le", 2},
+	{"av-short.avi", "avi", "mpeg4", "mp2", 2},
+	{"av-short.ts", "mpegts", "mpeg2video", "mp2", 2},
+	{"video-only.mkv", "matroska", "mpeg4", nullptr, 5},
+	{"video-only.mp4", "mp4", "mpeg4", nullptr, 5},
+	{"audio-only.wav", "wav", nullptr, "pcm_s16le", 10},
+	{"audio-only.m4a", "mp4", nullptr, "aac", 10},
+	{"audio-only.ogg", "ogg", nullptr, "flac", 30},
+};
+
+static bool file_exists(const std::string &path) {
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 && st.st_size > 0;
+}
+
+static std::string lavfi_url(const CorpusSpec &spec) {
+	char video[160], audio[160], url[400];
+	snprintf(video, sizeof(video), "testsrc2=size=320x240:rate=25:duration=%d", spec.seconds);
+	snprintf(audio, sizeof(audio), "sine=frequency=440:sample_rate=48000:duration=%d", spec.seconds);
+	if (spec.vcodec && spec.acodec) snprintf(url, sizeof(url), "av://lavfi:%s[out0];%s[out1]", video, audio);
+	else snprintf(url, sizeof(url), "av://lavfi:%s", spec.vcodec ? video : audio);
+	return url;
+}
+
+static bool encode_file(const CorpusSpec &spec, const std::string &out_path) {
+	mpv_handle *enc = mpv_create();
+	if (!enc) return false;
+	mpv_set_option_string(enc, "o", out_path.c_str());
+	mpv_set_option_string(enc, "of", spec.format);
+	if (spec.vcodec) mpv_set_option_string(enc, "ovc", spec.vcodec);
+	if (spec.acodec) mpv_set_option_string(enc, "oac", spec.acodec);
+	mpv_set_option_string(enc, "vid", spec.vcodec ? "auto" : "no");
+	mpv_set_option_string(enc, "aid", spec.acodec ? "auto" : "no");
+	mpv_set_option_string(enc, "idle", "yes");
+	if (mpv_initialize(enc) < 0) {
+		mpv_terminate_destroy(enc);
+		return false;
+	}
+
+	std::string url = lavfi_url(spec);
+	const char *cmd[] = {"loadfile", url.c_str(), nullptr};
+	bool ok = mpv_command(enc, cmd) >= 0;
+	while (ok) {
+		mpv_event *event = mpv_wait_event(enc, 5.0);
+		if (event->event_id == MPV_EVENT_END_FILE) {
+			auto *ef = static_cast<mpv_event_end_file *>(event->data);
+			ok = ef->reason == MPV_END_FILE_REASON_EOF;
+			break;
+		}
+		if (event->event_id == MPV_EVENT_SHUTDOWN) ok = false;
+	}
+	// The muxer trailer is written while the core shuts down
+	mpv_terminate_destroy(enc);
+	return ok && file_exists(out_path);
+}
+
+static std::vector<std::string> build_corpus(const BenchOptions &opt, BenchResults &results) {
+	mkdir(opt.corpus.c_str(), 0755);
+	std::vector<std::string> files;
+	uint64_t gen_start = os_gettime_ns();
+	int generated = 0;
+	for (const auto &spec : k_corpus) {
+		std::string path = opt.corpus + "/" + spec.name;
+		if (opt.regen || !file_exists(path)) {
+			if (!encode_file(spec, path)) {
+				fprintf(stderr, "warning: could not generate %s (encoder missing?), skipping\n", spec.name);
+				continue;
+			}
+			generated++;
+		}
+		files.push_back(path);
+	}
+	if (generated > 0) fprintf(stderr, "generated %d corpus files in %.1f s\n", generated, (os_gettime_ns() - gen_start) / 1e9);
+	results.push_back({"corpus_files", (double)files.size()});
+	return files;
+}
+
+static std::string base_name(const std::string &path) {
+	size_t slash = path.find_last_of('/');
+	return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static obs_data_t *playlist_settings(const std::vector<std::string> &files, int count) {
+	obs_data_t *settings = obs_data_create();
+	obs_data_array_t *playlist = obs_data_array_create();
+	for (int i = 0; i < count; i++) {
+		const std::string &path = files[(size_t)i % files.size()];
+		obs_data_t *item = obs_data_create();
+		obs_data_set_string(item, "path", path.c_str());
+		obs_data_set_string(item, "name", base_name(path).c_str());
+		obs_data_set_double(item, "volume", 100.0);
+		obs_data_array_push_back(playlist, item);
+		obs_data_release(item);
+	}
+	obs_data_set_array(settings, "playlist", playlist);
+	obs_data_array_release(playlist);
+	return settings;
+}
+
+// Probes run on the worker pool; the tick applies their results
+static void wait_loads(ObsMpvSource *source) {
+	while (source->loads_pending()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		ObsMpvSource::obs_video_tick(source, 0.001f);
+	}
+}
+
+static void clear_playlist(ObsMpvSource *source) {
+	while (source->playlist_count() > 0) source->playlist_remove(source->playlist_count() - 1);
+}
+
+// Compares time and memory keys against a saved run. A key regresses when it
+// grew by more than the tolerance and by more than a small absolute slack, so
+// sub-millisecond noise on fast files does not trip the check.
+static int compare_baseline(const BenchOptions &opt, const BenchResults &results) {
+	auto base = bench_load(opt.baseline);
+	if (base.empty()) {
+		fprintf(stderr, "baseline %s is missing or empty\n", opt.baseline);
+		return 1;
+	}
+	int regressions = 0;
+	printf("\n%-28s %10s %10s %8s\n", "baseline", "before", "after", "change");
+	for (const auto &r : results) {
+		bool is_time = r.first.find("_ms") != std::string::npos;
+		bool is_mem = r.first.find("_mb") != std::string::npos;
+		auto it = base.find(r.first);
+		if ((!is_time && !is_mem) || it == base.end()) continue;
+		double before = it->second, after = r.second;
+		double change = before > 0.0 ? (after - before) / before * 100.0 : 0.0;
+		double slack = is_time ? 1.0 : 2.0;
+		bool regressed = change > opt.tolerance && after - before > slack;
+		if (regressed) regressions++;
+		printf("%-28s %10.3f %10.3f %+7.1f%%%s\n", r.first.c_str(), before, after, change,
+		       regressed ? "  REGRESSION" : "");
+	}
+	printf("regressions %d (tolerance %.1f%%)\n", regressions, opt.tolerance);
+	return regressions > 0 ? 2 : 0;
+}
+
+int main(int argc, char **argv) {
+	BenchOptions opt = parse_options(argc, argv);
+	bench_set_log_level(opt.verbose ? LOG_INFO : LOG_ERROR);
+
+	BenchResults results;
+	std::vector<std::string> files = build_corpus(opt, results);
+	if (files.empty()) {
+		fprintf(stderr, "no corpus files available in %s\n", opt.corpus.c_str());
+		return 1;
+	}
+
+	obs_source_t *fake_source = reinterpret_cast<obs_source_t *>(&opt);
+	ObsMpvSource::obs_get_defaults(bench_source_settings());
+	auto *source = static_cast<ObsMpvSource *>(ObsMpvSource::obs_create(bench_source_settings(), fake_source));
+	results.push_back({"rss_idle_mb", bench_rss_mb()});
+
+	// Per-file latency. "call" includes spinning up the probe mpv instance,
+	// "probe" is only the loadfile-to-metadata part reported by the source.
+	std::vector<double> call_ms, probe_ms;
+	for (const auto &path : files) {
+		std::vector<double> file_call, file_probe;
+		for (int r = 0; r < opt.repeat; r++) {
+			uint64_t t0 = os_gettime_ns();
+			source->playlist_add(path);
+			wait_loads(source);
+			file_call.push_back((os_gettime_ns() - t0) / 1e6);
+			file_probe.push_back(source->get_stats().probe_ms_last);
+			ObsMpvSource::PlaylistItem item;
+			bool have_item = source->playlist_get_item(source->playlist_count() - 1, item);
+			if (r == 0 && have_item && item.duration <= 0.0)
+				fprintf(stderr, "warning: %s probed without a duration\n", base_name(path).c_str());
+			clear_playlist(source);
+		}
+		double median = bench_percentile(file_probe, 50);
+		results.push_back({"probe_ms." + base_name(path), median});
+		call_ms.insert(call_ms.end(), file_call.begin(), file_call.end());
+		probe_ms.insert(probe_ms.end(), file_probe.begin(), file_probe.end());
+	}
+	results.push_back({"probe_ms_p50", bench_percentile(probe_ms, 50)});
+	results.push_back({"probe_ms_p95", bench_percentile(probe_ms, 95)});
+	results.push_back({"probe_ms_max", bench_percentile(probe_ms, 100)});
+	results.push_back({"probe_call_ms_p50", bench_percentile(call_ms, 50)});
+	results.push_back({"probe_call_ms_p95", bench_percentile(call_ms, 95)});
+
+	// Whole corpus in one playlist_add_multiple call; "call" is how long the
+	// caller (the dock) is blocked
+	{
+		uint64_t t0 = os_gettime_ns();
+		source->playlist_add_multiple(files);
+		results.push_back({"add_multiple_call_ms", (os_gettime_ns() - t0) / 1e6});
+		wait_loads(source);
+		double ms = (os_gettime_ns() - t0) / 1e6;
+		results.push_back({"add_multiple_ms", ms});
+		results.push_back({"add_multiple_ms_per_item", ms / (double)files.size()});
+		clear_playlist(source);
+	}
+
+	// Restoring saved N-item playlists, as on scene collection load
+	for (int n : opt.items) {
+		obs_data_t *settings = playlist_settings(files, n);
+		double rss_before = bench_rss_mb();
+		uint64_t t0 = os_gettime_ns();
+		source->load_playlist(settings);
+		double ms = (os_gettime_ns() - t0) / 1e6;
+
+		// Items without saved metadata are probed off the load path; the tick
+		// picks up the results
+		wait_loads(source);
+		double probe_ms = (os_gettime_ns() - t0) / 1e6;
+		double rss_after = bench_rss_mb();
+
+		std::string suffix = "." + std::to_string(n);
+		results.push_back({"load_ms" + suffix, ms});
+		results.push_back({"load_ms_per_item" + suffix, ms / (double)n});
+		results.push_back({"load_probe_ms" + suffix, probe_ms});
+		results.push_back({"load_rss_delta_mb" + suffix, rss_after - rss_before});
+		if (source->playlist_count() != n)
+			fprintf(stderr, "warning: load_playlist produced %d items, expected %d\n", source->playlist_count(), n);
+
+		// Saved again, the playlist carries its metadata and loads without probing
+		source->save_playlist(settings);
+		t0 = os_gettime_ns();
+		source->load_playlist(settings);
+		results.push_back({"load_saved_ms" + suffix, (os_gettime_ns() - t0) / 1e6});
+		if (source->loads_pending()) fprintf(stderr, "warning: saved playlist of %d items was probed again\n", n);
+
+		// A whole source with that playlist, until it could start playing
+		obs_data_t *source_settings = bench_source_settings();
+		obs_data_array_t *playlist = obs_data_get_array(settings, "playlist");
+		obs_data_set_array(source_settings, "playlist", playlist);
+		obs_data_array_release(playlist);
+		t0 = os_gettime_ns();
+		auto *loaded = static_cast<ObsMpvSource *>(ObsMpvSource::obs_create(source_settings, fake_source));
+		results.push_back({"create_ms" + suffix, (os_gettime_ns() - t0) / 1e6});
+		t0 = os_gettime_ns();
+		ObsMpvSource::obs_show(loaded);
+		results.push_back({"first_show_ms" + suffix, (os_gettime_ns() - t0) / 1e6});
+		ObsMpvSource::obs_destroy(loaded);
+
+		obs_data_release(settings);
+		clear_playlist(source);
+	}
+
+	ObsMpvSource::obs_destroy(source);
+	results.push_back({"rss_final_mb", bench_rss_mb()});
+
+	bench_print(stdout, results);
+	if (opt.save) {
+		FILE *f = fopen(opt.save, "w");
+		if (f) {
+			bench_print(f, results);
+			fclose(f);
+		} else {
+			fprintf(stderr, "could not write %s\n", opt.save);
+		}
+	}
+	return opt.baseline ? compare_baseline(opt, results) : 0;
+}
@@ -0,0 +1,243 @@
+#include "obs-stubs.hpp"
+
+#include <obs-module.h>
+#include <util/platform.h>
+#include <plugin-support.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+struct obs_data_array;
+
+struct obs_data {
+	struct Value {
+		std::string str;
+		long long num = 0;
+		double dbl = 0.0;
+		bool flag = false;
+		obs_data_array *array = nullptr;
+	};
+	std::atomic<long> refs{1};
+	std::map<std::string, Value> values;
+	std::map<std::string, Value> defaults;
+
+	const Value *find(const char *name) const {
+		auto it = values.find(name);
+		if (it != values.end()) return &it->second;
+		auto def = defaults.find(name);
+		return def != defaults.end() ? &def->second : nullptr;
+	}
+};
+
+struct obs_data_array {
+	std::atomic<long> refs{1};
+	std::vector<obs_data_t *> items;
+};
+
+static int g_log_level = LOG_ERROR;
+
+BenchHooks &bench_hooks() {
+	static BenchHooks hooks;
+	return hooks;
+}
+
+obs_data_t *bench_source_settings() {
+	static obs_data_t *settings = obs_data_create();
+	return settings;
+}
+
+void bench_set_log_level(int level) { g_log_level = level; }
+
+extern "C" {
+
+const char *PLUGIN_NAME = "obs-mpv-bench";
+const char *PLUGIN_VERSION = "bench";
+
+void blogva(int log_level, const char *format, va_list args) {
+	if (log_level > g_log_level) return;
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+}
+
+void blog(int log_level, const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	blogva(log_level, format, args);
+	va_end(args);
+}
+
+void obs_log(int log_level, const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	blogva(log_level, format, args);
+	va_end(args);
+}
+
+uint64_t os_gettime_ns(void) {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+FILE *os_fopen(const char *path, const char *mode) { return fopen(path, mode); }
+
+bool os_file_exists(const char *path) {
+	FILE *f = fopen(path, "rb");
+	if (f) fclose(f);
+	return f != nullptr;
+}
+
+int64_t os_fgetsize(FILE *file) {
+	long pos = ftell(file);
+	if (fseek(file, 0, SEEK_END) != 0) return -1;
+	int64_t size = (int64_t)ftell(file);
+	fseek(file, pos, SEEK_SET);
+	return size;
+}
+
+int os_mkdirs(const char *) { return 0; }
+int os_unlink(const char *path) { return remove(path); }
+
+// No module config directory, so no saved plugin-wide defaults
+char *obs_module_config_path(const char *) { return nullptr; }
+void bfree(void *ptr) { free(ptr); }
+obs_data_t *obs_data_create_from_json_file_safe(const char *, const char *) { return nullptr; }
+bool obs_data_save_json_safe(obs_data_t *, const char *, const char *, const char *) { return false; }
+
+const char *obs_module_text(const char *lookup_string) { return lookup_string; }
+
+void obs_source_output_video(obs_source_t *, const struct obs_source_frame *frame) {
+	if (bench_hooks().video) bench_hooks().video(frame);
+}
+
+void obs_source_output_audio(obs_source_t *, const struct obs_source_audio *audio) {
+	if (bench_hooks().audio) bench_hooks().audio(audio);
+}
+
+bool obs_get_audio_info(struct obs_audio_info *oai) {
+	oai->samples_per_sec = 48000;
+	oai->speakers = SPEAKERS_STEREO;
+	return true;
+}
+
+bool obs_get_video_info(struct obs_video_info *ovi) {
+	*ovi = {};
+	ovi->fps_num = 60;
+	ovi->fps_den = 1;
+	ovi->base_width = ovi->output_width = 1920;
+	ovi->base_height = ovi->output_height = 1080;
+	return true;
+}
+
+uint64_t obs_get_video_frame_time(void) { return os_gettime_ns(); }
+
+int obs_reset_video(struct obs_video_info *) { return 0; }
+
+// No frontend, so no scenes: "match scene item bounds" falls back to native size
+void obs_enum_scenes(bool (*)(void *, obs_source_t *), void *) {}
+obs_scene_t *obs_scene_from_source(const obs_source_t *) { return nullptr; }
+void obs_scene_enum_items(obs_scene_t *, bool (*)(obs_scene_t *, obs_sceneitem_t *, void *), void *) {}
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *) { return nullptr; }
+enum obs_bounds_type obs_sceneitem_get_bounds_type(const obs_sceneitem_t *) { return OBS_BOUNDS_NONE; }
+void obs_sceneitem_get_bounds(const obs_sceneitem_t *, struct vec2 *bounds) { bounds->x = bounds->y = 0.0f; }
+bool obs_sceneitem_is_group(obs_sceneitem_t *) { return false; }
+void obs_sceneitem_group_enum_items(obs_sceneitem_t *, bool (*)(obs_scene_t *, obs_sceneitem_t *, void *), void *) {}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *) {
+	obs_data_t *settings = bench_source_settings();
+	obs_data_addref(settings);
+	return settings;
+}
+
+proc_handler_t *obs_source_get_proc_handler(const obs_source_t *) { return nullptr; }
+void proc_handler_add(proc_handler_t *, const char *, proc_handler_proc_t, void *) {}
+void calldata_set_data(calldata_t *, const char *, const void *, size_t) {}
+
+obs_properties_t *obs_properties_create(void) { return nullptr; }
+obs_property_t *obs_properties_add_bool(obs_properties_t *, const char *, const char *) { return nullptr; }
+obs_property_t *obs_properties_add_int(obs_properties_t *, const char *, const char *, int, int, int) { return nullptr; }
+obs_property_t *obs_properties_add_int_slider(obs_properties_t *, const char *, const char *, int, int, int) { return nullptr; }
+obs_property_t *obs_properties_add_float(obs_properties_t *, const char *, const char *, double, double, double) { return nullptr; }
+obs_property_t *obs_properties_add_list(obs_properties_t *, const char *, const char *, enum obs_combo_type, enum obs_combo_format) { return nullptr; }
+size_t obs_property_list_add_int(obs_property_t *, const char *, long long) { return 0; }
+size_t obs_property_list_add_string(obs_property_t *, const char *, const char *) { return 0; }
+obs_property_t *obs_properties_add_button(obs_properties_t *, const char *, const char *, obs_property_clicked_t) { return nullptr; }
+void obs_property_int_set_suffix(obs_property_t *, const char *) {}
+void obs_property_float_set_suffix(obs_property_t *, const char *) {}
+void obs_property_set_long_description(obs_property_t *, const char *) {}
+
+obs_data_t *obs_data_create(void) { return new obs_data; }
+void obs_data_addref(obs_data_t *data) {
+	if (data) data->refs++;
+}
+void obs_data_release(obs_data_t *data) {
+	if (!data || --data->refs > 0) return;
+	for (auto &kv : data->values) obs_data_array_release(kv.second.array);
+	delete data;
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val) { data->values[name].str = val ? val : ""; }
+void obs_data_set_int(obs_data_t *data, const char *name, long long val) { data->values[name].num = val; }
+void obs_data_set_double(obs_data_t *data, const char *name, double val) { data->values[name].dbl = val; }
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val) { data->values[name].flag = val; }
+void obs_data_set_array(obs_data_t *data, const char *name, obs_data_array_t *array) {
+	auto &v = data->values[name];
+	if (array) array->refs++;
+	obs_data_array_release(v.array);
+	v.array = array;
+}
+
+void obs_data_set_default_string(obs_data_t *data, const char *name, const char *val) { data->defaults[name].str = val ? val : ""; }
+void obs_data_set_default_int(obs_data_t *data, const char *name, long long val) { data->defaults[name].num = val; }
+void obs_data_set_default_double(obs_data_t *data, const char *name, double val) { data->defaults[name].dbl = val; }
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val) { data->defaults[name].flag = val; }
+
+const char *obs_data_get_string(obs_data_t *data, const char *name) {
+	auto v = data->find(name);
+	return v ? v->str.c_str() : "";
+}
+long long obs_data_get_int(obs_data_t *data, const char *name) {
+	auto v = data->find(name);
+	return v ? v->num : 0;
+}
+double obs_data_get_double(obs_data_t *data, const char *name) {
+	auto v = data->find(name);
+	return v ? v->dbl : 0.0;
+}
+bool obs_data_get_bool(obs_data_t *data, const char *name) {
+	auto v = data->find(name);
+	return v ? v->flag : false;
+}
+obs_data_array_t *obs_data_get_array(obs_data_t *data, const char *name) {
+	auto v = data->find(name);
+	if (!v || !v->array) return nullptr;
+	v->array->refs++;
+	return v->array;
+}
+bool obs_data_has_user_value(obs_data_t *data, const char *name) { return data->values.count(name) > 0; }
+
+obs_data_array_t *obs_data_array_create(void) { return new obs_data_array; }
+void obs_data_array_release(obs_data_array_t *array) {
+	if (!array || --array->refs > 0) return;
+	for (obs_data_t *item : array->items) obs_data_release(item);
+	delete array;
+}
+size_t obs_data_array_count(obs_data_array_t *array) { return array ? array->items.size() : 0; }
+obs_data_t *obs_data_array_item(obs_data_array_t *array, size_t idx) {
+	if (!array || idx >= array->items.size()) return nullptr;
+	obs_data_addref(array->items[idx]);
+	return array->items[idx];
+}
+size_t obs_data_array_push_back(obs_data_array_t *array, obs_data_t *obj) {
+	obs_data_addref(obj);
+	array->items.push_back(obj);
+	return array->items.size() - 1;
+}
+
+} // extern "C"
@@ -0,0 +1,21 @@
+#pragma once
+
+// Minimal stand-ins for the libobs calls made by the playback core, so it
+// can run headless. Only what ObsMpvSource touches is implemented; the
+// benchmarks observe its output through these hooks.
+
+#include <functional>
+#include <obs.h>
+
+struct BenchHooks {
+	std::function<void(const struct obs_source_frame *)> video;
+	std::function<void(const struct obs_source_audio *)> audio;
+};
+
+BenchHooks &bench_hooks();
+
+// Settings object returned by obs_source_get_settings() for every source.
+obs_data_t *bench_source_settings();
+
+// Prints libobs/plugin log lines at or above this level (LOG_ERROR by default).
+void bench_set_log_level(int level);
@@ -0,0 +1,96 @@
+#include "mpv-audio-pipe.hpp"
+#include <cerrno>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MpvAudioPipe::MpvAudioPipe() {
+	char name[256];
+	snprintf(name, sizeof(name), "\\\\.\\pipe\\obs_mpv_audio_%p", (void *)this);
+	m_path = name;
+	m_handle = CreateNamedPipeA(m_path.c_str(), PIPE_ACCESS_INBOUND, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT, 1,
+				    4096 * 32, 4096 * 32, 0, NULL);
+}
+
+MpvAudioPipe::~MpvAudioPipe() {
+	if (m_handle != INVALID_HANDLE_VALUE) {
+		DisconnectNamedPipe(m_handle);
+		CloseHandle(m_handle);
+	}
+}
+
+bool MpvAudioPipe::is_valid() const { return m_handle != INVALID_HANDLE_VALUE; }
+
+bool MpvAudioPipe::connect() {
+	if (m_handle == INVALID_HANDLE_VALUE) return false;
+	return ConnectNamedPipe(m_handle, NULL) || GetLastError() == ERROR_PIPE_CONNECTED;
+}
+
+void MpvAudioPipe::interrupt() {
+	// Connecting and closing a client completes a pending ConnectNamedPipe
+	// and makes the next read fail with a broken pipe.
+	HANDLE client = CreateFileA(m_path.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	if (client != INVALID_HANDLE_VALUE) CloseHandle(client);
+}
+
+int64_t MpvAudioPipe::read(void *buf, size_t size) {
+	DWORD bytes_read = 0;
+	if (!ReadFile(m_handle, buf, (DWORD)size, &bytes_read, NULL)) return -1;
+	return (int64_t)bytes_read;
+}
+
+void MpvAudioPipe::drain() {
+	char scratch[4096];
+	DWORD avail = 0;
+	while (PeekNamedPipe(m_handle, NULL, 0, NULL, &avail, NULL) && avail > 0) {
+		DWORD bytes_read = 0;
+		if (!ReadFile(m_handle, scratch, avail < sizeof(scratch) ? avail : (DWORD)sizeof(scratch), &bytes_read, NULL) || bytes_read == 0) break;
+	}
+}
+#else
+MpvAudioPipe::MpvAudioPipe() {
+	int fds[2];
+	if (pipe(fds) != 0) return;
+
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+	m_read_fd = fds[0];
+	m_write_fd = fds[1];
+
+	// mpv opens this path itself; the write end stays open on our side for
+	// the whole lifetime, so the reader never sees EOF when mpv reopens its
+	// output between files.
+	m_path = "/dev/fd/" + std::to_string(m_write_fd);
+}
+
+MpvAudioPipe::~MpvAudioPipe() {
+	if (m_read_fd >= 0) close(m_read_fd);
+	if (m_write_fd >= 0) close(m_write_fd);
+}
+
+bool MpvAudioPipe::is_valid() const { return m_read_fd >= 0 && m_write_fd >= 0; }
+
+bool MpvAudioPipe::connect() { return is_valid(); }
+
+void MpvAudioPipe::interrupt() {} // Reads never block
+
+int64_t MpvAudioPipe::read(void *buf, size_t size) {
+	ssize_t n = ::read(m_read_fd, buf, size);
+	if (n >= 0) return (int64_t)n;
+	return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+}
+
+void MpvAudioPipe::drain() {
+	char scratch[4096];
+	while (::read(m_read_fd, scratch, sizeof(scratch)) > 0);
+}
+#endif
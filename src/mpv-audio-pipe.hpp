@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Anonymous pipe that libmpv's "pcm" audio output writes raw samples into.
+// On POSIX this is a pipe(2) handed to mpv as /dev/fd/<n>, so nothing is
+// created on the filesystem and the read end is usable immediately.
+// Windows keeps using a per-instance named pipe, which lives in the pipe
+// namespace rather than on disk.
+class MpvAudioPipe {
+public:
+	MpvAudioPipe();
+	~MpvAudioPipe();
+
+	MpvAudioPipe(const MpvAudioPipe &) = delete;
+	MpvAudioPipe &operator=(const MpvAudioPipe &) = delete;
+
+	bool is_valid() const;
+
+	// Value for mpv's "ao-pcm-file" option.
+	const std::string &path() const { return m_path; }
+
+	// Waits for mpv to open the write side. No-op on POSIX.
+	bool connect();
+
+	// Wakes a reader blocked in connect() or read() once mpv is gone, so its
+	// thread can be joined. No-op on POSIX.
+	void interrupt();
+
+	// Reads up to size bytes. Returns the byte count, 0 if nothing is
+	// available right now (POSIX only, the read end is non-blocking) and
+	// -1 on error.
+	int64_t read(void *buf, size_t size);
+
+	// Discards everything currently buffered in the pipe.
+	void drain();
+
+private:
+#ifdef _WIN32
+	void *m_handle;
+#else
+	int m_read_fd = -1;
+	int m_write_fd = -1;
+#endif
+	std::string m_path;
+};
@@ -0,0 +1,190 @@
+#include "mpv-audio.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MPV_AUDIO_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MPV_AUDIO_NEON 1
+#include <arm_neon.h>
+#endif
+
+enum speaker_layout mpv_audio_speakers(int channels) {
+	switch (channels) {
+	case 1: return SPEAKERS_MONO;
+	case 2: return SPEAKERS_STEREO;
+	case 3: return SPEAKERS_2POINT1;
+	case 4: return SPEAKERS_4POINT0;
+	case 5: return SPEAKERS_4POINT1;
+	case 6: return SPEAKERS_5POINT1;
+	case 8: return SPEAKERS_7POINT1;
+	default: return SPEAKERS_UNKNOWN;
+	}
+}
+
+const char *mpv_audio_layout_name(enum speaker_layout speakers) {
+	switch (speakers) {
+	case SPEAKERS_MONO: return "mono";
+	case SPEAKERS_STEREO: return "stereo";
+	case SPEAKERS_2POINT1: return "2.1";
+	case SPEAKERS_4POINT0: return "4.0";
+	case SPEAKERS_4POINT1: return "4.1";
+	case SPEAKERS_5POINT1: return "5.1";
+	case SPEAKERS_7POINT1: return "7.1";
+	default: return nullptr;
+	}
+}
+
+static void deinterleave_scalar(const float *src, float *const *dst, size_t start, size_t frames, int channels) {
+	for (size_t i = start; i < frames; i++) {
+		for (int c = 0; c < channels; c++) dst[c][i] = src[i * channels + c];
+	}
+}
+
+#if defined(MPV_AUDIO_SSE2)
+static size_t deinterleave_simd(const float *src, float *const *dst, size_t frames, int channels) {
+	size_t i = 0;
+	if (channels == 2) {
+		for (; i + 4 <= frames; i += 4) {
+			__m128 a = _mm_loadu_ps(src + i * 2);
+			__m128 b = _mm_loadu_ps(src + i * 2 + 4);
+			_mm_storeu_ps(dst[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(dst[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+	} else if (channels == 4 || channels == 8) {
+		// 4x4 transposes: 4 frames of (up to) 4 channels at a time
+		for (; i + 4 <= frames; i += 4) {
+			for (int base = 0; base < channels; base += 4) {
+				__m128 r0 = _mm_loadu_ps(src + (i + 0) * channels + base);
+				__m128 r1 = _mm_loadu_ps(src + (i + 1) * channels + base);
+				__m128 r2 = _mm_loadu_ps(src + (i + 2) * channels + base);
+				__m128 r3 = _mm_loadu_ps(src + (i + 3) * channels + base);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(dst[base + 0] + i, r0);
+				_mm_storeu_ps(dst[base + 1] + i, r1);
+				_mm_storeu_ps(dst[base + 2] + i, r2);
+				_mm_storeu_ps(dst[base + 3] + i, r3);
+			}
+		}
+	}
+	return i;
+}
+#elif defined(MPV_AUDIO_NEON)
+static size_t deinterleave_simd(const float *src, float *const *dst, size_t frames, int channels) {
+	size_t i = 0;
+	if (channels == 2) {
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x2_t v = vld2q_f32(src + i * 2);
+			vst1q_f32(dst[0] + i, v.val[0]);
+			vst1q_f32(dst[1] + i, v.val[1]);
+		}
+	} else if (channels == 4) {
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x4_t v = vld4q_f32(src + i * 4);
+			for (int c = 0; c < 4; c++) vst1q_f32(dst[c] + i, v.val[c]);
+		}
+	}
+	return i;
+}
+#else
+static size_t deinterleave_simd(const float *, float *const *, size_t, int) { return 0; }
+#endif
+
+void mpv_audio_deinterleave(const float *src, float *const *dst, size_t frames, int channels) {
+	if (channels == 1) {
+		for (size_t i = 0; i < frames; i++) dst[0][i] = src[i];
+		return;
+	}
+	size_t done = deinterleave_simd(src, dst, frames, channels);
+	deinterleave_scalar(src, dst, done, frames, channels);
+}
+
+void mpv_audio_apply_gain(float *samples, size_t count, float gain) {
+	for (size_t i = 0; i < count; i++) samples[i] *= gain; // Simple enough for the compiler to vectorize
+}
+
+static void measure_scalar(const float *src, float *peak, float *sum_sq, size_t start, size_t frames, int channels) {
+	for (size_t i = start; i < frames; i++) {
+		for (int c = 0; c < channels; c++) {
+			float v = src[i * channels + c];
+			peak[c] = std::max(peak[c], std::fabs(v));
+			sum_sq[c] += v * v;
+		}
+	}
+}
+
+// The SIMD versions walk the interleaved samples in periods of
+// lcm(channels, 4) floats, i.e. channels / gcd(channels, 4) vectors. Lane l
+// of vector k then always holds channel (4k + l) % channels, so any layout
+// is measured with plain vertical max/multiply-add and folded per channel
+// once at the end.
+#if defined(MPV_AUDIO_SSE2)
+static size_t measure_simd(const float *src, float *peak, float *sum_sq, size_t frames, int channels) {
+	int g = channels % 4 == 0 ? 4 : channels % 2 == 0 ? 2 : 1;
+	int vectors = channels / g;
+	size_t period = 4 / g; // Frames
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 vpeak[MAX_AUDIO_CHANNELS], vsq[MAX_AUDIO_CHANNELS];
+	for (int k = 0; k < vectors; k++) vpeak[k] = vsq[k] = _mm_setzero_ps();
+
+	size_t i = 0;
+	for (; i + period <= frames; i += period) {
+		const float *p = src + i * channels;
+		for (int k = 0; k < vectors; k++) {
+			__m128 v = _mm_loadu_ps(p + 4 * k);
+			vpeak[k] = _mm_max_ps(vpeak[k], _mm_and_ps(v, abs_mask));
+			vsq[k] = _mm_add_ps(vsq[k], _mm_mul_ps(v, v));
+		}
+	}
+
+	float lanes_peak[4 * MAX_AUDIO_CHANNELS], lanes_sq[4 * MAX_AUDIO_CHANNELS];
+	for (int k = 0; k < vectors; k++) {
+		_mm_storeu_ps(lanes_peak + 4 * k, vpeak[k]);
+		_mm_storeu_ps(lanes_sq + 4 * k, vsq[k]);
+	}
+	for (int j = 0; j < 4 * vectors; j++) {
+		peak[j % channels] = std::max(peak[j % channels], lanes_peak[j]);
+		sum_sq[j % channels] += lanes_sq[j];
+	}
+	return i;
+}
+#elif defined(MPV_AUDIO_NEON)
+static size_t measure_simd(const float *src, float *peak, float *sum_sq, size_t frames, int channels) {
+	int g = channels % 4 == 0 ? 4 : channels % 2 == 0 ? 2 : 1;
+	int vectors = channels / g;
+	size_t period = 4 / g; // Frames
+	float32x4_t vpeak[MAX_AUDIO_CHANNELS], vsq[MAX_AUDIO_CHANNELS];
+	for (int k = 0; k < vectors; k++) vpeak[k] = vsq[k] = vdupq_n_f32(0.0f);
+
+	size_t i = 0;
+	for (; i + period <= frames; i += period) {
+		const float *p = src + i * channels;
+		for (int k = 0; k < vectors; k++) {
+			float32x4_t v = vld1q_f32(p + 4 * k);
+			vpeak[k] = vmaxq_f32(vpeak[k], vabsq_f32(v));
+			vsq[k] = vmlaq_f32(vsq[k], v, v);
+		}
+	}
+
+	float lanes_peak[4 * MAX_AUDIO_CHANNELS], lanes_sq[4 * MAX_AUDIO_CHANNELS];
+	for (int k = 0; k < vectors; k++) {
+		vst1q_f32(lanes_peak + 4 * k, vpeak[k]);
+		vst1q_f32(lanes_sq + 4 * k, vsq[k]);
+	}
+	for (int j = 0; j < 4 * vectors; j++) {
+		peak[j % channels] = std::max(peak[j % channels], lanes_peak[j]);
+		sum_sq[j % channels] += lanes_sq[j];
+	}
+	return i;
+}
+#else
+static size_t measure_simd(const float *, float *, float *, size_t, int) { return 0; }
+#endif
+
+void mpv_audio_measure(const float *src, size_t frames, int channels, float *peak, float *sum_sq) {
+	for (int c = 0; c < channels; c++) peak[c] = sum_sq[c] = 0.0f;
+	size_t done = measure_simd(src, peak, sum_sq, frames, channels);
+	measure_scalar(src, peak, sum_sq, done, frames, channels);
+}
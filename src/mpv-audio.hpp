@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <obs.h>
+
+// Channel layouts the plugin asks mpv to produce. Every entry maps 1:1 onto
+// an OBS speaker layout in the same (WAVEFORMATEXTENSIBLE) channel order,
+// so anything mpv decodes is up/downmixed to something OBS can take as-is.
+#define MPV_AUDIO_CHANNEL_LAYOUTS "mono,stereo,2.1,4.0,4.1,5.1,7.1"
+
+// Maps an interleaved channel count coming out of mpv to the OBS layout.
+// Returns SPEAKERS_UNKNOWN for counts outside MPV_AUDIO_CHANNEL_LAYOUTS.
+enum speaker_layout mpv_audio_speakers(int channels);
+
+// Inverse of mpv_audio_speakers: the mpv "audio-channels" value that
+// produces the given OBS layout, or nullptr if there is none.
+const char *mpv_audio_layout_name(enum speaker_layout speakers);
+
+// Splits interleaved float samples into one plane per channel.
+// dst must hold `channels` pointers with room for `frames` samples each.
+void mpv_audio_deinterleave(const float *src, float *const *dst, size_t frames, int channels);
+
+// Scales samples in place; used for the per-item loudness gain.
+void mpv_audio_apply_gain(float *samples, size_t count, float gain);
+
+// Per-channel absolute peak and sum of squares of interleaved float samples,
+// for level meters. peak and sum_sq must hold `channels` entries each and
+// are overwritten.
+void mpv_audio_measure(const float *src, size_t frames, int channels, float *peak, float *sum_sq);
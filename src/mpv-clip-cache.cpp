@@ -0,0 +1,166 @@
+#include "mpv-clip-cache.hpp"
+
+#include <mpv/client.h>
+#include <mpv/stream_cb.h>
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// One open stream; holds its own reference so eviction cannot pull the
+// buffer out from under a playing clip.
+struct MemStream {
+	std::shared_ptr<const std::vector<uint8_t>> data;
+	uint64_t pos = 0;
+};
+
+int64_t mem_read(void *cookie, char *buf, uint64_t nbytes) {
+	auto s = static_cast<MemStream *>(cookie);
+	uint64_t left = s->data->size() - s->pos;
+	uint64_t n = std::min(nbytes, left);
+	memcpy(buf, s->data->data() + s->pos, n);
+	s->pos += n;
+	return (int64_t)n;
+}
+
+int64_t mem_seek(void *cookie, int64_t offset) {
+	auto s = static_cast<MemStream *>(cookie);
+	if (offset < 0 || (uint64_t)offset > s->data->size()) return MPV_ERROR_GENERIC;
+	s->pos = (uint64_t)offset;
+	return offset;
+}
+
+int64_t mem_size(void *cookie) { return (int64_t) static_cast<MemStream *>(cookie)->data->size(); }
+
+void mem_close(void *cookie) { delete static_cast<MemStream *>(cookie); }
+
+} // namespace
+
+void MpvClipCache::attach(mpv_handle *mpv) { mpv_stream_cb_add_ro(mpv, kProtocol, this, open_stream); }
+
+void MpvClipCache::set_limit_mb(int mb) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_limit = (size_t)std::max(mb, 1) << 20;
+	evict_locked({});
+}
+
+bool MpvClipCache::preload(const std::string &path) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_clips.count(path)) return true;
+	}
+	return load(path) != nullptr;
+}
+
+std::string MpvClipCache::play_url(const std::string &path) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_clips.find(path);
+	if (it != m_clips.end()) {
+		m_hits++;
+		it->second.last_used = ++m_uses;
+		return std::string(kProtocol) + "://" + path;
+	}
+
+	// Called with the mpv lock held, possibly from the video tick: play from
+	// disk now rather than wait for the read
+	m_misses++;
+	if (m_loading.insert(path).second) {
+		MpvWorkerPool::instance().submit(m_tasks, MpvTaskPriority::Prefetch, [this, path] {
+			load(path);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_loading.erase(path);
+		});
+	}
+	return path;
+}
+
+MpvClipCache::Stats MpvClipCache::stats() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Stats st;
+	st.hits = m_hits;
+	st.misses = m_misses;
+	st.bytes = m_bytes;
+	st.clips = m_clips.size();
+	return st;
+}
+
+MpvClipCache::Buffer MpvClipCache::load(const std::string &path) {
+	FILE *f = os_fopen(path.c_str(), "rb");
+	if (!f) {
+		obs_log(LOG_WARNING, "Preload: cannot open %s", path.c_str());
+		return nullptr;
+	}
+	int64_t size = os_fgetsize(f);
+	size_t limit;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		limit = m_limit;
+	}
+	if (size <= 0 || (uint64_t)size > limit) {
+		obs_log(LOG_WARNING, "Preload: %s does not fit the clip cache (%lld bytes)", path.c_str(), (long long)size);
+		fclose(f);
+		return nullptr;
+	}
+
+	auto data = std::make_shared<std::vector<uint8_t>>((size_t)size);
+	size_t got = fread(data->data(), 1, data->size(), f);
+	fclose(f);
+	if (got != data->size()) {
+		obs_log(LOG_WARNING, "Preload: short read on %s", path.c_str());
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Clip &clip = m_clips[path];
+	if (clip.data) return clip.data; // Loaded by someone else meanwhile
+	clip.data = data;
+	clip.last_used = ++m_uses;
+	m_bytes += data->size();
+	evict_locked(path);
+	return data;
+}
+
+void MpvClipCache::evict_locked(const std::string &keep) {
+	while (m_bytes > m_limit && !m_clips.empty()) {
+		auto victim = m_clips.end();
+		for (auto it = m_clips.begin(); it != m_clips.end(); ++it) {
+			if (it->first == keep) continue;
+			if (victim == m_clips.end() || it->second.last_used < victim->second.last_used) victim = it;
+		}
+		if (victim == m_clips.end()) break;
+		m_bytes -= victim->second.data->size();
+		m_clips.erase(victim);
+	}
+}
+
+MpvClipCache::Buffer MpvClipCache::find(const std::string &path) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_clips.find(path);
+		if (it != m_clips.end()) return it->second.data;
+	}
+	return load(path); // Evicted between play_url and mpv opening it (on mpv's thread)
+}
+
+int MpvClipCache::open_stream(void *user_data, char *uri, mpv_stream_cb_info *info) {
+	auto self = static_cast<MpvClipCache *>(user_data);
+	size_t prefix = strlen(kProtocol) + 3; // "://"
+	if (strlen(uri) <= prefix) return MPV_ERROR_LOADING_FAILED;
+
+	Buffer data = self->find(uri + prefix);
+	if (!data) return MPV_ERROR_LOADING_FAILED;
+
+	auto s = new MemStream;
+	s->data = std::move(data);
+	info->cookie = s;
+	info->read_fn = mem_read;
+	info->seek_fn = mem_seek;
+	info->size_fn = mem_size;
+	info->close_fn = mem_close;
+	return 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "mpv-worker-pool.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct mpv_handle;
+
+// Whole files held in memory for playlist items marked "preload", so short
+// clips that are fired again and again (stingers, jingles) start without
+// touching the disk. mpv reads them through a stream_cb protocol:
+// loadfile "obsmpvmem://<path>" plays the resident copy of <path>.
+//
+// Bounded by a byte limit with least-recently-played eviction. A clip that is
+// playing keeps its buffer alive even if it gets evicted meanwhile. Files are
+// read without holding the cache lock, and never on the playback path: a
+// clip that is not resident plays from disk while it loads in the background.
+class MpvClipCache {
+public:
+	static constexpr const char *kProtocol = "obsmpvmem";
+
+	struct Stats {
+		uint64_t hits = 0;   // Plays served from memory
+		uint64_t misses = 0; // Plays that had to (re)load the file first
+		uint64_t bytes = 0;
+		uint64_t clips = 0;
+	};
+
+	// Registers the protocol with an mpv handle (before any loadfile).
+	void attach(mpv_handle *mpv);
+
+	void set_limit_mb(int mb);
+
+	// Reads path into memory unless it is already resident, on the calling
+	// thread. Files larger than the limit are refused.
+	bool preload(const std::string &path);
+
+	// For a play of path: counts a hit or miss and returns the URL to hand
+	// to loadfile. On a miss that is the plain path, and the file is queued
+	// to be loaded for the next play.
+	std::string play_url(const std::string &path);
+
+	Stats stats();
+
+private:
+	using Buffer = std::shared_ptr<const std::vector<uint8_t>>;
+	struct Clip {
+		Buffer data;
+		uint64_t last_used = 0;
+	};
+
+	std::mutex m_mutex;
+	std::unordered_map<std::string, Clip> m_clips;
+	size_t m_bytes = 0;
+	size_t m_limit = (size_t)256 << 20;
+	uint64_t m_uses = 0;
+	uint64_t m_hits = 0;
+	uint64_t m_misses = 0;
+	std::unordered_set<std::string> m_loading; // Queued by play_url
+
+	Buffer load(const std::string &path); // Reads without m_mutex
+	void evict_locked(const std::string &keep);
+	Buffer find(const std::string &path);
+
+	MpvTaskGroup m_tasks; // Last, so loads finish before the rest is destroyed
+
+	static int open_stream(void *user_data, char *uri, struct mpv_stream_cb_info *info);
+};
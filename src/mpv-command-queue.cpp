@@ -0,0 +1,131 @@
+#include "mpv-command-queue.hpp"
+
+#include <mpv/client.h>
+#include <obs-module.h>
+#include <plugin-support.h>
+
+#include <vector>
+
+void MpvCommandQueue::attach(mpv_handle *mpv) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_mpv = mpv;
+	m_requests.clear();
+	m_slots.clear();
+	m_stats.in_flight = 0;
+}
+
+void MpvCommandQueue::command(std::initializer_list<const char *> args) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_mpv || args.size() == 0) return;
+	std::vector<const char *> argv(args);
+	argv.push_back(nullptr);
+	uint64_t id = track_locked(argv[0], std::string());
+	int err = mpv_command_async(m_mpv, id, argv.data());
+	if (err < 0) {
+		m_requests.erase(id);
+		m_stats.in_flight--;
+		m_stats.failed++;
+		obs_log(LOG_WARNING, "mpv %s failed: %s", argv[0], mpv_error_string(err));
+	}
+}
+
+void MpvCommandQueue::set(const char *name, const char *value) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_mpv) return;
+	Value v;
+	v.is_text = true;
+	v.text = value;
+	send_set_locked(name, v, false);
+}
+
+void MpvCommandQueue::set_latest(const char *name, double value) {
+	Value v;
+	v.number = value;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	set_latest_locked(name, std::move(v));
+}
+
+void MpvCommandQueue::set_latest(const char *name, const char *value) {
+	Value v;
+	v.is_text = true;
+	v.text = value;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	set_latest_locked(name, std::move(v));
+}
+
+void MpvCommandQueue::drop_pending(const char *name) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_slots.find(name);
+	if (it != m_slots.end()) it->second.waiting = false;
+}
+
+bool MpvCommandQueue::handle_reply(const mpv_event *event) {
+	if (event->event_id != MPV_EVENT_COMMAND_REPLY && event->event_id != MPV_EVENT_SET_PROPERTY_REPLY) return false;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_requests.find(event->reply_userdata);
+	if (it == m_requests.end()) return false;
+	Request request = std::move(it->second);
+	m_requests.erase(it);
+	m_stats.in_flight--;
+
+	if (event->error < 0) {
+		m_stats.failed++;
+		obs_log(LOG_WARNING, "mpv %s failed: %s", request.what.c_str(), mpv_error_string(event->error));
+	}
+
+	// The slot is free again; send whatever arrived meanwhile
+	if (!request.slot.empty()) {
+		Slot &slot = m_slots[request.slot];
+		slot.in_flight = false;
+		if (slot.waiting && m_mpv) {
+			slot.waiting = false;
+			send_set_locked(request.slot, slot.value, true);
+		}
+	}
+	return true;
+}
+
+MpvCommandQueue::Stats MpvCommandQueue::stats() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void MpvCommandQueue::set_latest_locked(const char *name, Value value) {
+	if (!m_mpv) return;
+	Slot &slot = m_slots[name];
+	if (slot.in_flight) {
+		if (slot.waiting) m_stats.coalesced++;
+		slot.value = std::move(value);
+		slot.waiting = true;
+		return;
+	}
+	send_set_locked(name, value, true);
+}
+
+void MpvCommandQueue::send_set_locked(const std::string &name, const Value &value, bool coalesced) {
+	uint64_t id = track_locked("set " + name, coalesced ? name : std::string());
+	int err;
+	if (value.is_text) {
+		const char *text = value.text.c_str();
+		err = mpv_set_property_async(m_mpv, id, name.c_str(), MPV_FORMAT_STRING, &text);
+	} else {
+		double number = value.number;
+		err = mpv_set_property_async(m_mpv, id, name.c_str(), MPV_FORMAT_DOUBLE, &number);
+	}
+	if (err < 0) {
+		m_requests.erase(id);
+		m_stats.in_flight--;
+		m_stats.failed++;
+		obs_log(LOG_WARNING, "mpv set %s failed: %s", name.c_str(), mpv_error_string(err));
+		return;
+	}
+	if (coalesced) m_slots[name].in_flight = true;
+}
+
+uint64_t MpvCommandQueue::track_locked(std::string what, std::string slot) {
+	uint64_t id = m_next_id++;
+	m_requests[id] = Request{std::move(what), std::move(slot)};
+	m_stats.sent++;
+	m_stats.in_flight++;
+	return id;
+}
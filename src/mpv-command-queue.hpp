@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct mpv_handle;
+struct mpv_event;
+
+// Control commands for one mpv instance, sent with mpv's async API so the
+// caller (usually the dock, on the UI thread) never waits for mpv's core.
+// Replies come back through the source's event loop (handle_reply), which
+// counts and logs failures.
+//
+// Properties set with set_latest() are coalesced: while a set of a property
+// is in flight, newer values only replace the one waiting, and the last of
+// them goes out when mpv replies. Dragging the volume or seek slider thus
+// keeps at most one request per property queued in mpv. Everything else is
+// sent immediately, in call order.
+class MpvCommandQueue {
+public:
+	struct Stats {
+		uint64_t sent = 0;
+		uint64_t coalesced = 0; // Values superseded before they were sent
+		uint64_t failed = 0;
+		int in_flight = 0;
+	};
+
+	// Binds to an instance after mpv_initialize, or unbinds (nullptr) before
+	// it is destroyed; anything waiting or in flight is forgotten either way.
+	// Calls made while unbound are dropped.
+	void attach(mpv_handle *mpv);
+
+	void command(std::initializer_list<const char *> args);
+	void set(const char *name, const char *value);
+
+	void set_latest(const char *name, double value);
+	void set_latest(const char *name, const char *value);
+	// Forgets a value still waiting to be sent, e.g. a seek meant for the
+	// file that a loadfile or stop is replacing
+	void drop_pending(const char *name);
+
+	// For MPV_EVENT_COMMAND_REPLY and MPV_EVENT_SET_PROPERTY_REPLY; false
+	// for anything that was not sent through this queue.
+	bool handle_reply(const mpv_event *event);
+
+	Stats stats();
+
+private:
+	struct Value {
+		bool is_text = false;
+		double number = 0.0;
+		std::string text;
+	};
+	struct Slot {
+		bool in_flight = false;
+		bool waiting = false;
+		Value value; // The waiting value
+	};
+	struct Request {
+		std::string what; // For the log
+		std::string slot; // Coalescing slot, empty for plain requests
+	};
+
+	std::mutex m_mutex;
+	mpv_handle *m_mpv = nullptr;
+	uint64_t m_next_id = 1; // Reply ids; 0 stays with untracked requests
+	std::unordered_map<uint64_t, Request> m_requests;
+	std::unordered_map<std::string, Slot> m_slots;
+	Stats m_stats;
+
+	void set_latest_locked(const char *name, Value value);
+	void send_set_locked(const std::string &name, const Value &value, bool coalesced);
+	uint64_t track_locked(std::string what, std::string slot);
+};
@@ -2,10 +2,17 @@
 #include "obs-mpv-source.hpp"
 #include "playlist-table-widget.hpp"
 #include "mpv-sub-dialog.hpp"
+#include "mpv-instance-budget.hpp"
+#include "mpv-level-meter.hpp"
+#include "mpv-seek-preview.hpp"
+#include "mpv-thumbnails.hpp"
+#include "mpv-worker-pool.hpp"
+#include "mpv-trace.hpp"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QLabel>
+#include <QLineEdit>
 #include <QSlider>
 #include <QComboBox>
 #include <QSpinBox>
@@ -14,12 +21,19 @@
 #include <QFormLayout>
 #include <QAbstractItemView>
 #include <QFileDialog>
+#include <QDir>
 #include <QGroupBox>
 #include <QHeaderView>
+#include <QImage>
+#include <QMouseEvent>
+#include <QPixmap>
+#include <QShortcut>
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 
 #include "plugin-support.h"
+#include <algorithm>
+#include <cmath>
 
 MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_currentSource(nullptr), m_isSeeking(false) {
     setObjectName("MPVControls");
@@ -46,16 +60,20 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
 
     // --- Playlist Table ---
     m_table = new PlaylistTableWidget(this, content);
-    m_table->setColumnCount(6);
-    m_table->setHorizontalHeaderLabels({"File", "Duration", "FPS", "Ch", "Loop", "Subs"});
+    m_table->setColumnCount(7);
+    m_table->setHorizontalHeaderLabels({"", "File", "Duration", "FPS", "Ch", "Loop", "Subs"});
     m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_table->setSelectionMode(QAbstractItemView::SingleSelection);
-    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
-    m_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    m_table->setIconSize(QSize(MpvThumbnail::kWidth, MpvThumbnail::kHeight));
+    m_table->verticalHeader()->setDefaultSectionSize(MpvThumbnail::kHeight + 4);
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed);
+    m_table->setColumnWidth(0, MpvThumbnail::kWidth + 8);
+    m_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
     m_table->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
     m_table->horizontalHeader()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
     m_table->horizontalHeader()->setSectionResizeMode(4, QHeaderView::ResizeToContents);
     m_table->horizontalHeader()->setSectionResizeMode(5, QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(6, QHeaderView::ResizeToContents);
     layout->addWidget(m_table);
 
     // --- Playlist Controls ---
@@ -81,7 +99,21 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     // Seek Slider
     m_sliderSeek = new QSlider(Qt::Horizontal, content);
     m_sliderSeek->setRange(0, 1000);
+    m_sliderSeek->setMouseTracking(true);
+    m_sliderSeek->installEventFilter(this);
     controlsLayout->addWidget(m_sliderSeek);
+
+    // Scrub preview shown above the slider while hovering or dragging
+    m_seekPreview = new QWidget(this, Qt::ToolTip | Qt::FramelessWindowHint);
+    QVBoxLayout *previewLayout = new QVBoxLayout(m_seekPreview);
+    previewLayout->setContentsMargins(2, 2, 2, 2);
+    previewLayout->setSpacing(2);
+    m_seekPreviewImage = new QLabel(m_seekPreview);
+    m_seekPreviewImage->setFixedSize(MpvSeekFrame::kWidth, MpvSeekFrame::kHeight);
+    m_seekPreviewTime = new QLabel(m_seekPreview);
+    m_seekPreviewTime->setAlignment(Qt::AlignCenter);
+    previewLayout->addWidget(m_seekPreviewImage);
+    previewLayout->addWidget(m_seekPreviewTime);
     
     // Time Labels
     QHBoxLayout *timeLayout = new QHBoxLayout();
@@ -103,6 +135,8 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     m_sliderVolume->setValue(100);
     volLayout->addWidget(m_sliderVolume);
     controlsLayout->addLayout(volLayout);
+    m_meter = new MpvLevelMeter(content);
+    controlsLayout->addWidget(m_meter);
 
     // Transport Controls
     QHBoxLayout *btns = new QHBoxLayout();
@@ -116,6 +150,49 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     btns->addWidget(m_btnPause);
     btns->addWidget(m_btnStop);
     controlsLayout->addLayout(btns);
+
+    // Jumps, seek precision and time entry
+    QHBoxLayout *seekRow = new QHBoxLayout();
+    m_btnJumpBack = new QPushButton("⏪", content); m_btnJumpBack->setToolTip("Jump back");
+    m_spinJump = new QSpinBox(content);
+    m_spinJump->setRange(1, 600);
+    m_spinJump->setValue(10);
+    m_spinJump->setSuffix(" s");
+    m_btnJumpForward = new QPushButton("⏩", content); m_btnJumpForward->setToolTip("Jump forward");
+    m_comboSeekMode = new QComboBox(content);
+    m_comboSeekMode->addItem("Fast");
+    m_comboSeekMode->addItem("Exact");
+    m_comboSeekMode->setToolTip("Fast seeks land on the nearest keyframe before the target at once;\n"
+                                "exact seeks decode up to the target frame");
+    m_editTimeJump = new QLineEdit(content);
+    m_editTimeJump->setPlaceholderText("Go to h:m:s or ±s");
+    m_editTimeJump->setToolTip("Enter a position such as 1:30 or 0:02:15.5, or +10 / -5 to jump relative");
+    seekRow->addWidget(m_btnJumpBack);
+    seekRow->addWidget(m_spinJump);
+    seekRow->addWidget(m_btnJumpForward);
+    seekRow->addWidget(m_comboSeekMode);
+    seekRow->addWidget(m_editTimeJump, 1);
+    controlsLayout->addLayout(seekRow);
+
+    // Frame stepping and JKL shuttle
+    QHBoxLayout *shuttleRow = new QHBoxLayout();
+    m_btnShuttleBack = new QPushButton("J ◀◀", content);
+    m_btnShuttleBack->setToolTip("Play in reverse (J); press again for 2x, 4x, 8x");
+    m_btnShuttleStop = new QPushButton("K ■", content); m_btnShuttleStop->setToolTip("Pause shuttle (K)");
+    m_btnShuttleForward = new QPushButton("L ▶▶", content);
+    m_btnShuttleForward->setToolTip("Play forward (L); press again for 2x, 4x, 8x");
+    m_btnFrameBack = new QPushButton("◀|", content); m_btnFrameBack->setToolTip("Previous frame (,)");
+    m_btnFrameForward = new QPushButton("|▶", content); m_btnFrameForward->setToolTip("Next frame (.)");
+    m_lblShuttle = new QLabel(content);
+    m_lblShuttle->setMinimumWidth(30);
+    shuttleRow->addWidget(m_btnShuttleBack);
+    shuttleRow->addWidget(m_btnShuttleStop);
+    shuttleRow->addWidget(m_btnShuttleForward);
+    shuttleRow->addWidget(m_lblShuttle);
+    shuttleRow->addStretch();
+    shuttleRow->addWidget(m_btnFrameBack);
+    shuttleRow->addWidget(m_btnFrameForward);
+    controlsLayout->addLayout(shuttleRow);
     
     // Advanced Toggles
     QHBoxLayout *advBtns = new QHBoxLayout();
@@ -157,11 +234,28 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     form->addRow("Audio:", m_comboAudio);
     form->addRow("Subs:", m_comboSubs);
     form->addRow("Loops:", m_spinLoop);
+    m_spinImageDuration = new QDoubleSpinBox(content);
+    m_spinImageDuration->setRange(0.5, 3600.0);
+    m_spinImageDuration->setSingleStep(0.5);
+    m_spinImageDuration->setSuffix(" s");
+    m_spinImageDuration->setEnabled(false);
+    m_spinImageDuration->setToolTip("How long a still image item stays up before the playlist moves on");
+    form->addRow("Show image for:", m_spinImageDuration);
+    m_checkPreload = new QCheckBox("Preload into RAM", content);
+    m_checkPreload->setToolTip("Keep this file in memory so it starts instantly (stingers, jingles)");
+    form->addRow(m_checkPreload);
     form->addRow(fadeInLayout);
     form->addRow(fadeOutLayout);
     
-    m_checkAutoFPS = new QCheckBox("Auto Match OBS FPS", content);
-    form->addRow(m_checkAutoFPS);
+    // Order matches ObsMpvSource::FpsMode
+    m_comboFpsMode = new QComboBox(content);
+    m_comboFpsMode->addItem("Keep file rate");
+    m_comboFpsMode->addItem("Switch OBS to file FPS");
+    m_comboFpsMode->addItem("Conform to OBS FPS");
+    m_comboFpsMode->addItem("Conform + blend");
+    m_comboFpsMode->setToolTip("Switching OBS resets the whole video pipeline; conforming keeps OBS's rate and\n"
+                               "fits the file to it with pulldown (and optional frame blending)");
+    form->addRow("FPS:", m_comboFpsMode);
     
     // Subtitle Actions
     QHBoxLayout *subBtns = new QHBoxLayout();
@@ -173,6 +267,27 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
 
     controlsLayout->addLayout(form);
     layout->addWidget(controlsGroup);
+
+    // Per-source performance stats
+    m_lblStats = new QLabel(content);
+    m_lblStats->setStyleSheet("color: gray; font-size: 10px;");
+    m_lblStats->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(m_lblStats);
+    m_btnTrace = new QPushButton("Record Trace", content);
+    m_btnTrace->setCheckable(true);
+    m_btnTrace->setToolTip("Record a timeline of rendering, mpv events and audio output; saved as Chrome/Perfetto trace JSON when stopped");
+    layout->addWidget(m_btnTrace);
+
+    // Plugin-wide, like tracing
+    QHBoxLayout *instanceLayout = new QHBoxLayout();
+    instanceLayout->addWidget(new QLabel("Live mpv instances (all sources):", content));
+    m_spinInstanceLimit = new QSpinBox(content);
+    m_spinInstanceLimit->setRange(0, 256);
+    m_spinInstanceLimit->setSpecialValueText("No limit");
+    m_spinInstanceLimit->setValue(mpv_budget_limit());
+    m_spinInstanceLimit->setToolTip("When reached, the source idle the longest releases its mpv instance to make room");
+    instanceLayout->addWidget(m_spinInstanceLimit);
+    layout->addLayout(instanceLayout);
     
     layout->addStretch();
     setWidget(content);
@@ -181,12 +296,34 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     connect(m_comboSources, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MpvControlDock::onSourceChanged);
     connect(m_sliderSeek, &QSlider::sliderReleased, this, &MpvControlDock::onSeekSliderReleased);
     connect(m_sliderSeek, &QSlider::sliderPressed, [this]() { m_isSeeking = true; });
+    connect(m_sliderSeek, &QSlider::sliderMoved, this, &MpvControlDock::onSeekSliderMoved);
     connect(m_sliderVolume, &QSlider::valueChanged, this, &MpvControlDock::onVolumeChanged);
     
     connect(m_btnPlay, &QPushButton::clicked, this, &MpvControlDock::onPlayClicked);
     connect(m_btnPause, &QPushButton::clicked, this, &MpvControlDock::onPauseClicked);
     connect(m_btnStop, &QPushButton::clicked, this, &MpvControlDock::onStopClicked);
     connect(m_btnRestart, &QPushButton::clicked, this, &MpvControlDock::onRestartClicked);
+    connect(m_btnJumpBack, &QPushButton::clicked, [this]() { onJumpClicked(-1); });
+    connect(m_btnJumpForward, &QPushButton::clicked, [this]() { onJumpClicked(1); });
+    connect(m_comboSeekMode, QOverload<int>::of(&QComboBox::activated), this, &MpvControlDock::onSeekModeChanged);
+    connect(m_editTimeJump, &QLineEdit::returnPressed, this, &MpvControlDock::onTimeJumpReturnPressed);
+    connect(m_btnShuttleBack, &QPushButton::clicked, [this]() { onShuttle(-1); });
+    connect(m_btnShuttleStop, &QPushButton::clicked, [this]() { onShuttle(0); });
+    connect(m_btnShuttleForward, &QPushButton::clicked, [this]() { onShuttle(1); });
+    connect(m_btnFrameBack, &QPushButton::clicked, [this]() { onFrameStep(-1); });
+    connect(m_btnFrameForward, &QPushButton::clicked, [this]() { onFrameStep(1); });
+
+    // Only while the dock has focus; text fields still get these keys as typing
+    auto addKey = [this](Qt::Key key, QPushButton *button) {
+        QShortcut *shortcut = new QShortcut(QKeySequence(key), this);
+        shortcut->setContext(Qt::WidgetWithChildrenShortcut);
+        connect(shortcut, &QShortcut::activated, button, &QPushButton::click);
+    };
+    addKey(Qt::Key_J, m_btnShuttleBack);
+    addKey(Qt::Key_K, m_btnShuttleStop);
+    addKey(Qt::Key_L, m_btnShuttleForward);
+    addKey(Qt::Key_Comma, m_btnFrameBack);
+    addKey(Qt::Key_Period, m_btnFrameForward);
     
     connect(m_checkRestartOnActivate, &QCheckBox::clicked, [this](bool checked){
         if (m_currentSource) {
@@ -197,6 +334,11 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
         }
     });
     
+    connect(m_btnTrace, &QPushButton::toggled, this, &MpvControlDock::onTraceToggled);
+    connect(m_spinInstanceLimit, &QSpinBox::editingFinished, [this]() {
+        mpv_budget_set_limit(m_spinInstanceLimit->value());
+        mpv_budget_save();
+    });
     connect(m_btnSubSettings, &QPushButton::clicked, m_subDialog, &QDialog::show);
     connect(m_btnLoadSubs, &QPushButton::clicked, this, &MpvControlDock::onLoadSubsClicked);
 
@@ -211,13 +353,15 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     connect(m_checkFadeOut, &QCheckBox::clicked, this, &MpvControlDock::saveSettings);
     connect(m_spinFadeOut, &QDoubleSpinBox::editingFinished, this, &MpvControlDock::saveSettings);
     connect(m_spinLoop, &QSpinBox::editingFinished, this, &MpvControlDock::saveSettings);
+    connect(m_spinImageDuration, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MpvControlDock::onImageDurationChanged);
+    connect(m_checkPreload, &QCheckBox::clicked, this, &MpvControlDock::onPreloadToggled);
     
-    connect(m_checkAutoFPS, &QCheckBox::toggled, [this](bool checked){
+    connect(m_comboFpsMode, QOverload<int>::of(&QComboBox::activated), [this](int mode){
         ObsMpvSource *source = getCurrentMpvSource();
         if (source) {
-            source->set_auto_obs_fps(checked);
+            source->set_fps_mode(mode);
             obs_data_t *s = obs_source_get_settings(m_currentSource);
-            obs_data_set_bool(s, "auto_obs_fps", checked);
+            obs_data_set_int(s, "fps_mode", mode);
             obs_source_update(m_currentSource, s);
             obs_data_release(s);
         }
@@ -233,6 +377,10 @@ MpvControlDock::MpvControlDock(QWidget *parent) : QDockWidget(parent), m_current
     QTimer *timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &MpvControlDock::onTimerTick);
     timer->start(100);
+    // Meters need a faster refresh than the rest, and reading them is lock-free
+    QTimer *meterTimer = new QTimer(this);
+    connect(meterTimer, &QTimer::timeout, this, &MpvControlDock::updateMeter);
+    meterTimer->start(33);
 
     updateSourceList();
 }
@@ -246,6 +394,8 @@ void MpvControlDock::saveSettings() {
 }
 
 void MpvControlDock::onTimerTick() {
+    mpv_trace_thread_name("ui");
+    MPV_TRACE_SCOPE("dock_poll");
     updateSourceList();
     updateTimer(); 
     if (!m_currentSource) {
@@ -255,6 +405,12 @@ void MpvControlDock::onTimerTick() {
     }
     setEnabled(true);
     updateUiFromSource();
+    updateStats();
+
+    // Probes finished on the worker pool fill in duration, fps and tracks
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (source && source->playlist_revision() != m_playlistRevision) updatePlaylistTable();
+    else if (MpvThumbnailCache::instance().revision() != m_thumbnailRevision) updateThumbnails();
 }
 
 void MpvControlDock::updateSourceList() {
@@ -332,9 +488,20 @@ void MpvControlDock::updateUiFromSource() {
         m_sliderVolume->blockSignals(false);
     }
 
-    m_checkAutoFPS->blockSignals(true);
-    m_checkAutoFPS->setChecked(obs_data_get_bool(s, "auto_obs_fps"));
-    m_checkAutoFPS->blockSignals(false);
+    if (source && !m_comboFpsMode->view()->isVisible()) {
+        m_comboFpsMode->blockSignals(true);
+        m_comboFpsMode->setCurrentIndex(source->get_fps_mode());
+        m_comboFpsMode->blockSignals(false);
+    }
+    if (source && !m_comboSeekMode->view()->isVisible()) {
+        m_comboSeekMode->blockSignals(true);
+        m_comboSeekMode->setCurrentIndex(source->get_seek_mode());
+        m_comboSeekMode->blockSignals(false);
+    }
+    if (source) {
+        int speed = source->get_shuttle();
+        m_lblShuttle->setText(speed > 1 || speed < 0 ? QString("%1×").arg(speed) : QString());
+    }
     
     m_checkRestartOnActivate->blockSignals(true);
     m_checkRestartOnActivate->setChecked(obs_data_get_bool(s, "restart_on_activate"));
@@ -393,6 +560,7 @@ void MpvControlDock::onRestartClicked() {
 
 void MpvControlDock::onSeekSliderReleased() {
     m_isSeeking = false;
+    m_seekPreview->hide();
     if (m_currentSource) obs_source_media_set_time(m_currentSource, (int64_t)((m_sliderSeek->value()/1000.0) * obs_source_media_get_duration(m_currentSource)));
 }
 
@@ -402,16 +570,15 @@ void MpvControlDock::onVolumeChanged(int v) {
 
     int row = m_table->currentRow();
     if (row >= 0) {
-        ObsMpvSource::PlaylistItem* item = source->playlist_get_item(row);
-        if (item) {
-            item->volume = (double)v;
-        }
+        source->playlist_edit_item(row, [&](auto &item) { item.volume = (double)v; });
     }
 
-    // Also apply to currently playing source
+    // Also apply to the item playing now. Straight to the source's command
+    // queue: a full settings update per slider step would reload the
+    // playlist, and the queue keeps only the latest value waiting anyway
+    source->set_volume((double)v);
     obs_data_t *s = obs_source_get_settings(m_currentSource);
     obs_data_set_double(s, "volume", (double)v);
-    obs_source_update(m_currentSource, s);
     obs_data_release(s);
 }
 
@@ -422,10 +589,7 @@ void MpvControlDock::onAudioTrackChanged(int) {
     int track_id = m_comboAudio->currentData().toInt();
     int row = m_table->currentRow();
     if (row >= 0) {
-        ObsMpvSource::PlaylistItem* item = source->playlist_get_item(row);
-        if (item) {
-            item->audio_track = track_id;
-        }
+        source->playlist_edit_item(row, [&](auto &item) { item.audio_track = track_id; });
     }
 
     obs_data_t *s = obs_source_get_settings(m_currentSource);
@@ -441,10 +605,7 @@ void MpvControlDock::onSubTrackChanged(int) {
     int track_id = m_comboSubs->currentData().toInt();
     int row = m_table->currentRow();
     if (row >= 0) {
-        ObsMpvSource::PlaylistItem* item = source->playlist_get_item(row);
-        if (item) {
-            item->sub_track = track_id;
-        }
+        source->playlist_edit_item(row, [&](auto &item) { item.sub_track = track_id; });
     }
 
     obs_data_t *s = obs_source_get_settings(m_currentSource);
@@ -459,11 +620,10 @@ void MpvControlDock::onLoopCountChanged(int v) {
 
     int row = m_table->currentRow();
     if (row >= 0) {
-        ObsMpvSource::PlaylistItem* item = source->playlist_get_item(row);
-        if (item) {
-            item->loop_count = v;
-            item->loop = (v != 0); // Keep boolean for compatibility
-        }
+        source->playlist_edit_item(row, [&](auto &item) {
+            item.loop_count = v;
+            item.loop = (v != 0); // Keep boolean for compatibility
+        });
     }
     
     // Update visuals
@@ -476,8 +636,7 @@ void MpvControlDock::onFadeInToggled(bool checked) {
     if (!source) return;
     int row = m_table->currentRow();
     if (row >= 0) {
-        auto* item = source->playlist_get_item(row);
-        if (item) item->fade_in_enabled = checked;
+        source->playlist_edit_item(row, [&](auto &item) { item.fade_in_enabled = checked; });
     }
 }
 
@@ -486,8 +645,7 @@ void MpvControlDock::onFadeInChanged(double v) {
     if (!source) return;
     int row = m_table->currentRow();
     if (row >= 0) {
-        auto* item = source->playlist_get_item(row);
-        if (item) item->fade_in = v;
+        source->playlist_edit_item(row, [&](auto &item) { item.fade_in = v; });
     }
 }
 
@@ -497,8 +655,7 @@ void MpvControlDock::onFadeOutToggled(bool checked) {
     if (!source) return;
     int row = m_table->currentRow();
     if (row >= 0) {
-        auto* item = source->playlist_get_item(row);
-        if (item) item->fade_out_enabled = checked;
+        source->playlist_edit_item(row, [&](auto &item) { item.fade_out_enabled = checked; });
     }
 }
 
@@ -507,11 +664,33 @@ void MpvControlDock::onFadeOutChanged(double v) {
     if (!source) return;
     int row = m_table->currentRow();
     if (row >= 0) {
-        auto* item = source->playlist_get_item(row);
-        if (item) item->fade_out = v;
+        source->playlist_edit_item(row, [&](auto &item) { item.fade_out = v; });
     }
 }
 
+void MpvControlDock::onImageDurationChanged(double v) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (!source) return;
+    int row = m_table->currentRow();
+    if (row >= 0) {
+        bool changed = false;
+        source->playlist_edit_item(row, [&](auto &item) {
+            if (!item.is_image) return;
+            item.image_duration = v;
+            item.duration = v; // Takes effect the next time the item is shown
+            changed = true;
+        });
+        if (changed) updatePlaylistTable();
+    }
+}
+
+void MpvControlDock::onPreloadToggled(bool checked) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (!source) return;
+    int row = m_table->currentRow();
+    if (row >= 0) source->playlist_set_preload(row, checked);
+}
+
 void MpvControlDock::onLoadSubsClicked() {
     ObsMpvSource *source = getCurrentMpvSource();
     if (!source) return;
@@ -520,10 +699,7 @@ void MpvControlDock::onLoadSubsClicked() {
     if (!f.isEmpty()) {
         int row = m_table->currentRow();
         if (row >= 0) {
-            ObsMpvSource::PlaylistItem* item = source->playlist_get_item(row);
-            if (item) {
-                item->ext_sub_path = f.toStdString();
-            }
+            source->playlist_edit_item(row, [&](auto &item) { item.ext_sub_path = f.toStdString(); });
         }
 
         obs_data_t *s = obs_source_get_settings(m_currentSource);
@@ -542,8 +718,90 @@ void MpvControlDock::onSubSettingsClicked() {
         m_subDialog->activateWindow();
     }
 }
-void MpvControlDock::onSeekSliderMoved(int) {}
-void MpvControlDock::onTimeJumpReturnPressed() {}
+void MpvControlDock::onSeekSliderMoved(int value) {
+    double frac = value / (double)m_sliderSeek->maximum();
+    showSeekPreview(frac, (int)(frac * m_sliderSeek->width()));
+}
+
+bool MpvControlDock::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == m_sliderSeek) {
+        if (event->type() == QEvent::MouseMove && !m_isSeeking) {
+            int x = (int)static_cast<QMouseEvent *>(event)->position().x();
+            showSeekPreview(std::clamp(x / (double)m_sliderSeek->width(), 0.0, 1.0), x);
+        } else if (event->type() == QEvent::Leave && !m_isSeeking) {
+            m_seekPreview->hide();
+        }
+    }
+    return QDockWidget::eventFilter(watched, event);
+}
+
+// Frames come from the keyframe index MpvSeekPreview builds the first time a
+// file is scrubbed; until then only the time is shown
+void MpvControlDock::showSeekPreview(double frac, int x) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    ObsMpvSource::PlaylistItem item;
+    bool have_item = source && source->playlist_get_item(source->get_current_index(), item);
+    double duration = source ? source->get_duration() : 0.0;
+    if (!have_item || item.is_image || duration <= 0.0) {
+        m_seekPreview->hide();
+        return;
+    }
+
+    double t = frac * duration;
+    MpvSeekPreview::instance().request(item.path); // No-op once indexed or queued
+    auto frame = MpvSeekPreview::instance().frame_at(item.path, t);
+    if (frame) {
+        QImage image(frame->bgra.data(), MpvSeekFrame::kWidth, MpvSeekFrame::kHeight, MpvSeekFrame::kWidth * 4,
+                     QImage::Format_RGB32);
+        m_seekPreviewImage->setPixmap(QPixmap::fromImage(image));
+    }
+    m_seekPreviewImage->setVisible((bool)frame);
+    m_seekPreviewTime->setText(formatTime(t));
+    m_seekPreview->adjustSize();
+    m_seekPreview->move(m_sliderSeek->mapToGlobal(QPoint(x - m_seekPreview->width() / 2, -m_seekPreview->height() - 4)));
+    m_seekPreview->show();
+}
+void MpvControlDock::onTimeJumpReturnPressed() {
+    ObsMpvSource *source = getCurrentMpvSource();
+    QString text = m_editTimeJump->text().trimmed();
+    if (!source || text.isEmpty()) return;
+
+    bool relative = text.startsWith('+') || text.startsWith('-');
+    double t = parseTime(relative ? text.mid(1) : text);
+    if (t < 0) {
+        m_editTimeJump->selectAll(); // Leave it for correcting
+        return;
+    }
+    if (relative) source->seek_relative(text.startsWith('-') ? -t : t);
+    else source->seek(t);
+    m_editTimeJump->clear();
+}
+
+void MpvControlDock::onJumpClicked(int direction) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (source) source->seek_relative(direction * m_spinJump->value());
+}
+
+void MpvControlDock::onSeekModeChanged(int mode) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (!source) return;
+    source->set_seek_mode(mode);
+    // Saved without a settings update, which would reload the playlist
+    obs_data_t *s = obs_source_get_settings(m_currentSource);
+    obs_data_set_int(s, "seek_mode", mode);
+    obs_data_release(s);
+}
+
+void MpvControlDock::onShuttle(int direction) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (source) source->shuttle(direction);
+}
+
+void MpvControlDock::onFrameStep(int direction) {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (source) source->frame_step(direction);
+}
+
 void MpvControlDock::onSubScaleChanged(double) {}
 void MpvControlDock::onSubPosChanged(double) {}
 void MpvControlDock::onSubColorClicked() {}
@@ -606,35 +864,43 @@ void MpvControlDock::onItemClicked(QTableWidgetItem *item) {
     if (!source || !item) return;
 
     int row = item->row();
-    ObsMpvSource::PlaylistItem* playlist_item = source->playlist_get_item(row);
-    if (!playlist_item) return;
+    ObsMpvSource::PlaylistItem playlist_item;
+    if (!source->playlist_get_item(row, playlist_item)) return;
 
     m_sliderVolume->blockSignals(true);
-    m_sliderVolume->setValue(playlist_item->volume);
+    m_sliderVolume->setValue(playlist_item.volume);
     m_sliderVolume->blockSignals(false);
 
     m_spinLoop->blockSignals(true);
-    m_spinLoop->setValue(playlist_item->loop_count);
+    m_spinLoop->setValue(playlist_item.loop_count);
     m_spinLoop->blockSignals(false);
 
     m_checkFadeIn->blockSignals(true);
-    m_checkFadeIn->setChecked(playlist_item->fade_in_enabled);
+    m_checkFadeIn->setChecked(playlist_item.fade_in_enabled);
     m_checkFadeIn->blockSignals(false);
-    m_spinFadeIn->setEnabled(playlist_item->fade_in_enabled);
+    m_spinFadeIn->setEnabled(playlist_item.fade_in_enabled);
 
     m_spinFadeIn->blockSignals(true);
-    m_spinFadeIn->setValue(playlist_item->fade_in);
+    m_spinFadeIn->setValue(playlist_item.fade_in);
     m_spinFadeIn->blockSignals(false);
 
     m_checkFadeOut->blockSignals(true);
-    m_checkFadeOut->setChecked(playlist_item->fade_out_enabled);
+    m_checkFadeOut->setChecked(playlist_item.fade_out_enabled);
     m_checkFadeOut->blockSignals(false);
-    m_spinFadeOut->setEnabled(playlist_item->fade_out_enabled);
+    m_spinFadeOut->setEnabled(playlist_item.fade_out_enabled);
 
     m_spinFadeOut->blockSignals(true);
-    m_spinFadeOut->setValue(playlist_item->fade_out);
+    m_spinFadeOut->setValue(playlist_item.fade_out);
     m_spinFadeOut->blockSignals(false);
 
+    m_spinImageDuration->blockSignals(true);
+    m_spinImageDuration->setEnabled(playlist_item.is_image);
+    m_spinImageDuration->setValue(playlist_item.image_duration);
+    m_spinImageDuration->blockSignals(false);
+
+    m_checkPreload->setEnabled(!playlist_item.is_image);
+    m_checkPreload->setChecked(playlist_item.preload);
+
     auto populate = [](QComboBox *combo, const std::vector<ObsMpvSource::MpvTrack> &tracks, int current_id) {
         combo->blockSignals(true);
         combo->clear();
@@ -646,8 +912,8 @@ void MpvControlDock::onItemClicked(QTableWidgetItem *item) {
         combo->blockSignals(false);
     };
 
-    populate(m_comboAudio, playlist_item->audio_tracks, playlist_item->audio_track);
-    populate(m_comboSubs, playlist_item->sub_tracks, playlist_item->sub_track);
+    populate(m_comboAudio, playlist_item.audio_tracks, playlist_item.audio_track);
+    populate(m_comboSubs, playlist_item.sub_tracks, playlist_item.sub_track);
 }
 
 void MpvControlDock::updatePlaylistTable() {
@@ -657,7 +923,12 @@ void MpvControlDock::updatePlaylistTable() {
         return;
     }
 
-    m_table->setRowCount(source->playlist_count());
+    m_playlistRevision = source->playlist_revision();
+    m_thumbnailRevision = MpvThumbnailCache::instance().revision();
+    // One copy for the whole table, so rows stay consistent while the tick
+    // applies probe results
+    std::vector<ObsMpvSource::PlaylistItem> items = source->playlist_items();
+    m_table->setRowCount((int)items.size());
     double total_duration = 0.0;
 
     auto createItem = [](const QString &text) {
@@ -666,55 +937,78 @@ void MpvControlDock::updatePlaylistTable() {
         return item;
     };
 
-    for (int i = 0; i < source->playlist_count(); ++i) {
-        auto *item = source->playlist_get_item(i);
-        if (item) {
-            QString displayName = QString::fromStdString(item->name);
-            bool isCurrent = (i == source->m_current_index);
-
-            if (isCurrent) {
-                if (source->is_playing()) displayName = "▶ " + displayName;
-                else displayName = "⏸ " + displayName;
-            }
-
-            m_table->setItem(i, 0, createItem(displayName));
-            m_table->setItem(i, 1, createItem(formatTime(item->duration)));
+    for (int i = 0; i < (int)items.size(); ++i) {
+        const auto &item = items[i];
+        QString displayName = QString::fromStdString(item.name);
+        bool isCurrent = (i == source->m_current_index);
 
-            m_table->setItem(i, 2, createItem(item->fps > 0 ? QString::number(item->fps, 'f', 2) : ""));
-            m_table->setItem(i, 3, createItem(item->audio_channels > 0 ? QString::number(item->audio_channels) : ""));
-
-            QString loopStr;
-            if (item->loop_count < 0) loopStr = "∞";
-            else if (item->loop_count == 0) loopStr = "1";
-            else loopStr = QString::number(item->loop_count);
-            m_table->setItem(i, 4, createItem(loopStr));
-
-            QString subText = "No";
-            if (!item->ext_sub_path.empty()) subText = "Ext";
-            else if (!item->sub_tracks.empty()) subText = "Int";
-
-            m_table->setItem(i, 5, createItem(subText));
-
-            if (isCurrent) {
-                QFont font = m_table->font();
-                font.setBold(true);
-                QColor activeColor(0, 120, 215, 60); 
+        if (isCurrent) {
+            if (source->is_playing()) displayName = "▶ " + displayName;
+            else displayName = "⏸ " + displayName;
+        }
 
-                for (int c = 0; c < 6; c++) {
-                    QTableWidgetItem *cell = m_table->item(i, c);
-                    if (cell) {
-                        cell->setFont(font);
-                        cell->setBackground(activeColor);
-                    }
+        QTableWidgetItem *thumbCell = createItem("");
+        setThumbnail(thumbCell, item.path, item.is_image);
+        m_table->setItem(i, 0, thumbCell);
+        m_table->setItem(i, 1, createItem(displayName));
+        m_table->setItem(i, 2, createItem(formatTime(item.duration)));
+
+        m_table->setItem(i, 3, createItem(item.fps > 0 ? QString::number(item.fps, 'f', 2) : ""));
+        m_table->setItem(i, 4, createItem(item.audio_channels > 0 ? QString::number(item.audio_channels) : ""));
+
+        QString loopStr;
+        if (item.loop_count < 0) loopStr = "∞";
+        else if (item.loop_count == 0) loopStr = "1";
+        else loopStr = QString::number(item.loop_count);
+        m_table->setItem(i, 5, createItem(loopStr));
+
+        QString subText = "No";
+        if (!item.ext_sub_path.empty()) subText = "Ext";
+        else if (!item.sub_tracks.empty()) subText = "Int";
+
+        m_table->setItem(i, 6, createItem(subText));
+
+        if (isCurrent) {
+            QFont font = m_table->font();
+            font.setBold(true);
+            QColor activeColor(0, 120, 215, 60); 
+
+            for (int c = 0; c < 7; c++) {
+                QTableWidgetItem *cell = m_table->item(i, c);
+                if (cell) {
+                    cell->setFont(font);
+                    cell->setBackground(activeColor);
                 }
             }
-
-            total_duration += item->duration;
         }
+
+        total_duration += item.duration;
     }
     m_labelTotalDuration->setText("Total Duration: " + formatTime(total_duration));
 }
 
+// Thumbnails are made on the worker pool; until one is ready the cell stays
+// empty and updateThumbnails() fills it in later
+bool MpvControlDock::setThumbnail(QTableWidgetItem *cell, const std::string &path, bool still) {
+    auto thumb = MpvThumbnailCache::instance().get(path, still);
+    if (!thumb) return false;
+    QImage image(thumb->bgra.data(), MpvThumbnail::kWidth, MpvThumbnail::kHeight, MpvThumbnail::kWidth * 4,
+                 QImage::Format_RGB32);
+    cell->setData(Qt::DecorationRole, QPixmap::fromImage(image)); // Copies, so the cache may drop it
+    return true;
+}
+
+void MpvControlDock::updateThumbnails() {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (!source) return;
+    m_thumbnailRevision = MpvThumbnailCache::instance().revision();
+    std::vector<ObsMpvSource::PlaylistItem> items = source->playlist_items();
+    for (int i = 0; i < m_table->rowCount() && i < (int)items.size(); ++i) {
+        QTableWidgetItem *cell = m_table->item(i, 0);
+        if (cell && cell->data(Qt::DecorationRole).isNull()) setThumbnail(cell, items[i].path, items[i].is_image);
+    }
+}
+
 ObsMpvSource* MpvControlDock::getCurrentMpvSource() {
     if (!m_currentSource) return nullptr;
     return static_cast<ObsMpvSource*>(obs_obj_get_data(m_currentSource));
@@ -726,7 +1020,20 @@ QString MpvControlDock::formatTime(double seconds) {
     int s = (int)(seconds - (h * 3600) - (m * 60));
     return QString("%1:%2:%3").arg(h, 2, 10, QChar('0')).arg(m, 2, 10, QChar('0')).arg(s, 2, 10, QChar('0'));
 }
-double MpvControlDock::parseTime(const QString &) {return 0;}
+double MpvControlDock::parseTime(const QString &text) {
+    // [[h:]m:]s, seconds may have a fraction; -1 if it is not a time
+    QStringList parts = text.trimmed().split(':');
+    if (parts.size() > 3) return -1;
+    double seconds = 0;
+    for (int i = 0; i < parts.size(); i++) {
+        bool ok = false;
+        double v = parts[i].toDouble(&ok); // Always "." for the fraction
+        bool last = i == parts.size() - 1;
+        if (!ok || v < 0 || (!last && v != std::floor(v))) return -1;
+        seconds = seconds * 60 + v;
+    }
+    return seconds;
+}
 void MpvControlDock::populateTracks(QComboBox *, const char *) {}
 
 void MpvControlDock::updateTimer() {
@@ -759,3 +1066,113 @@ void MpvControlDock::updateTimer() {
         m_lblPlaylistRemaining->setText("Total: " + fmt(source->get_playlist_time_remaining()));
     }
 }
+
+void MpvControlDock::updateMeter() {
+    ObsMpvSource *source = getCurrentMpvSource();
+    ObsMpvSource::AudioLevels levels;
+    if (source && isVisible()) levels = source->get_audio_levels();
+    m_meter->setLevels(levels.channels, levels.peak, levels.rms);
+}
+
+void MpvControlDock::updateStats() {
+    ObsMpvSource *source = getCurrentMpvSource();
+    if (!source) {
+        m_lblStats->clear();
+        return;
+    }
+
+    ObsMpvSource::Stats st = source->get_stats();
+    QString text = QString("Render %1 / avg %2 / max %3 ms · %4 frames (%5 dropped, %6 repeated)\n"
+                           "Decoder %7 fps / container %8 fps · A/V %9 ms\n"
+                           "Audio queue %10 ms · %11 underruns · Probe %12 ms (avg %13)")
+                            .arg(st.render_ms_last, 0, 'f', 1)
+                            .arg(st.render_ms_avg, 0, 'f', 1)
+                            .arg(st.render_ms_max, 0, 'f', 1)
+                            .arg(st.frames_rendered)
+                            .arg(st.frames_dropped)
+                            .arg(st.frames_repeated)
+                            .arg(st.decoder_fps, 0, 'f', 2)
+                            .arg(st.container_fps, 0, 'f', 2)
+                            .arg(st.av_offset_ms, 0, 'f', 1)
+                            .arg(st.audio_queue_ms, 0, 'f', 0)
+                            .arg(st.audio_underruns)
+                            .arg(st.probe_ms_last, 0, 'f', 0)
+                            .arg(st.probe_ms_avg, 0, 'f', 0);
+    if (st.seeks > 0) {
+        text += QString("\nSeek to frame %1 ms (avg %2 over %3 seeks)")
+                    .arg(st.seek_ms_last, 0, 'f', 0)
+                    .arg(st.seek_ms_avg, 0, 'f', 0)
+                    .arg(st.seeks);
+    }
+    if (st.history_frames > 0 || st.steps_cached + st.steps_decoded > 0) {
+        text += QString("\nFrame history %1 frames (%2 MB) · %3 steps from memory, %4 decoded")
+                    .arg(st.history_frames)
+                    .arg(st.history_mb, 0, 'f', 0)
+                    .arg(st.steps_cached)
+                    .arg(st.steps_decoded);
+    }
+    if (st.frame_queue_capacity > 0) {
+        text += QString("\nFrame queue %1/%2 · %3 spikes (%4 absorbed)")
+                    .arg(st.frame_queue_depth)
+                    .arg(st.frame_queue_capacity)
+                    .arg(st.frame_spikes)
+                    .arg(st.spikes_absorbed);
+    }
+    if (!st.mpv_live) text += QString("\nmpv not running (not used yet or released when idle)");
+    else text += QString("\nHardware decoding: %1").arg(QString::fromStdString(st.hwdec_current));
+    text += QString("\n%1 mpv instances live%2")
+                .arg(st.live_instances)
+                .arg(st.instance_limit > 0 ? QString(" of %1").arg(st.instance_limit) : QString());
+    if (st.mpv_releases > 0) text += QString(" · released %1 times").arg(st.mpv_releases);
+    if (st.clip_cache_hits + st.clip_cache_misses > 0) {
+        text += QString("\nPreloaded clips %1 MB · %2 hits / %3 misses")
+                    .arg(st.clip_cache_mb, 0, 'f', 1)
+                    .arg(st.clip_cache_hits)
+                    .arg(st.clip_cache_misses);
+    }
+    if (st.frames_unchanged > 0) text += QString("\n%1 unchanged frames skipped").arg(st.frames_unchanged);
+    if (st.commands_sent > 0) {
+        text += QString("\nCommands %1 sent · %2 coalesced · %3 failed · %4 in flight")
+                    .arg(st.commands_sent)
+                    .arg(st.commands_coalesced)
+                    .arg(st.commands_failed)
+                    .arg(st.commands_in_flight);
+    }
+    if (st.loudness_measured) {
+        text += QString("\nLoudness %1 LUFS · peak %2 dBTP · auto gain %3 dB")
+                    .arg(st.loudness_lufs, 0, 'f', 1)
+                    .arg(st.true_peak_db, 0, 'f', 1)
+                    .arg(st.auto_gain_db, 0, 'f', 1);
+    }
+    MpvWorkerPool::Stats pool = MpvWorkerPool::instance().stats();
+    if (pool.workers > 0) {
+        text += QString("\nWorkers %1 · queued %2 interactive / %3 prefetch / %4 background · %5 done")
+                    .arg(pool.workers)
+                    .arg(pool.queued[(int)MpvTaskPriority::Interactive])
+                    .arg(pool.queued[(int)MpvTaskPriority::Prefetch])
+                    .arg(pool.queued[(int)MpvTaskPriority::Background])
+                    .arg(pool.completed);
+    }
+    if (st.output_width && (st.output_width != st.video_width || st.output_height != st.video_height)) {
+        text += QString("\nRendering %1x%2 (file %3x%4)")
+                    .arg(st.output_width)
+                    .arg(st.output_height)
+                    .arg(st.video_width)
+                    .arg(st.video_height);
+    }
+    m_lblStats->setText(text);
+}
+
+void MpvControlDock::onTraceToggled(bool checked) {
+    if (checked) {
+        mpv_trace_start();
+        m_btnTrace->setText("Stop && Save Trace");
+        return;
+    }
+
+    mpv_trace_stop();
+    m_btnTrace->setText("Record Trace");
+    QString path = QFileDialog::getSaveFileName(this, "Save Trace", QDir::homePath() + "/obs-mpv-trace.json",
+                                                "Trace JSON (*.json)");
+    if (!path.isEmpty()) mpv_trace_dump(path.toUtf8().constData());
+}
@@ -4,6 +4,7 @@
 #include <QTableWidgetItem>
 #include <QTimer>
 #include <obs.h>
+#include <string>
 
 class QComboBox;
 class QLabel;
@@ -16,6 +17,7 @@ class QLineEdit;
 class ObsMpvSource;
 class MpvSubSettingsDialog;
 class PlaylistTableWidget;
+class MpvLevelMeter;
 
 class MpvControlDock : public QDockWidget {
 	Q_OBJECT
@@ -29,6 +31,9 @@ public:
 	ObsMpvSource* getCurrentMpvSource();
 	void updatePlaylistTable();
 
+protected:
+	bool eventFilter(QObject *watched, QEvent *event) override;
+
 	private slots:
 	void onTimerTick();
 	void onSourceChanged(int index);
@@ -41,6 +46,8 @@ public:
 	void onFadeInChanged(double value);
 	void onFadeOutToggled(bool checked);
 	void onFadeOutChanged(double value);
+	void onImageDurationChanged(double value);
+	void onPreloadToggled(bool checked);
 	void onAudioTrackChanged(int index);
 	void onSubTrackChanged(int index);
 	void onVolumeChanged(int value);
@@ -64,7 +71,11 @@ public:
 private:
     QComboBox *m_comboSources;
     QSlider *m_sliderSeek;
+    QWidget *m_seekPreview;
+    QLabel *m_seekPreviewImage;
+    QLabel *m_seekPreviewTime;
     QSlider *m_sliderVolume;
+    MpvLevelMeter *m_meter;
     
     // Labels for Time
     QLabel *m_lblTimeCurrent;
@@ -76,6 +87,21 @@ private:
     QPushButton *m_btnPause;
     QPushButton *m_btnStop;
     QPushButton *m_btnRestart;
+
+    // Seeking
+    QPushButton *m_btnJumpBack;
+    QPushButton *m_btnJumpForward;
+    QSpinBox *m_spinJump;           // Jump size in seconds
+    QComboBox *m_comboSeekMode;     // Order matches ObsMpvSource::SeekMode
+    QLineEdit *m_editTimeJump;
+
+    // Frame stepping and JKL shuttle (also on the J, K, L, comma and period keys)
+    QPushButton *m_btnShuttleBack;
+    QPushButton *m_btnShuttleStop;
+    QPushButton *m_btnShuttleForward;
+    QPushButton *m_btnFrameBack;
+    QPushButton *m_btnFrameForward;
+    QLabel *m_lblShuttle;
     
     // Toggles
     QCheckBox *m_checkRestartOnActivate; // "Restart when active"
@@ -88,8 +114,10 @@ private:
     QDoubleSpinBox *m_spinFadeIn;
     QCheckBox *m_checkFadeOut;
     QDoubleSpinBox *m_spinFadeOut;
+    QDoubleSpinBox *m_spinImageDuration; // Still-image items only
+    QCheckBox *m_checkPreload;
 
-    QCheckBox *m_checkAutoFPS;
+    QComboBox *m_comboFpsMode;
 
     QPushButton *m_btnLoadSubs;
     QPushButton *m_btnSubSettings;
@@ -101,9 +129,14 @@ private:
     QPushButton *m_btnUp;
     QPushButton *m_btnDown;
     QLabel *m_labelTotalDuration;
+    QLabel *m_lblStats;
+    QPushButton *m_btnTrace;
+    QSpinBox *m_spinInstanceLimit; // Plugin-wide (mpv-instance-budget.hpp)
 
     QTimer *m_timer;
     obs_source_t *m_currentSource;
+    uint32_t m_playlistRevision = 0; // Last ObsMpvSource::playlist_revision() shown
+    uint32_t m_thumbnailRevision = 0; // Last MpvThumbnailCache::revision() shown
     bool m_isSeeking;
     uint32_t m_currentSubColor;
 
@@ -116,7 +149,17 @@ private:
     void onPauseClicked();
     void onRestartClicked();
     void onRestartFadeClicked();
+    void onJumpClicked(int direction);
+    void onSeekModeChanged(int mode);
+    void onShuttle(int direction);
+    void onFrameStep(int direction);
     void updateTimer();
+    void updateStats();
+    void updateMeter();
+    void updateThumbnails();
+    void showSeekPreview(double frac, int x);
+    bool setThumbnail(QTableWidgetItem *cell, const std::string &path, bool still);
+    void onTraceToggled(bool checked);
     void saveSettings(); // Generic saver
 
     QString formatTime(double seconds);
@@ -0,0 +1,90 @@
+#include "mpv-frame-history.hpp"
+
+#include <cstring>
+
+void MpvFrameHistory::set_limit_mb(int mb) {
+	m_limit = mb > 0 ? (size_t)mb << 20 : 0;
+	while (m_bytes > m_limit && !m_frames.empty()) drop_front();
+	if (!m_limit) release();
+}
+
+void MpvFrameHistory::push_back(const uint8_t *data, uint32_t width, uint32_t height, double time) {
+	if (!m_limit) return;
+	m_frames.push_back(make_frame(data, width, height, time));
+	m_bytes += m_frames.back().data.size();
+	while (m_bytes > m_limit && m_frames.size() > 1) drop_front();
+	m_cursor = m_anchor = m_frames.size() - 1;
+}
+
+void MpvFrameHistory::push_front(const uint8_t *data, uint32_t width, uint32_t height, double time) {
+	if (!m_limit) return;
+	m_frames.push_front(make_frame(data, width, height, time));
+	m_bytes += m_frames.front().data.size();
+	while (m_bytes > m_limit && m_frames.size() > 1) drop_back();
+	m_cursor = m_anchor = 0;
+}
+
+void MpvFrameHistory::clear() {
+	for (auto &frame : m_frames) recycle(frame);
+	m_frames.clear();
+	m_bytes = 0;
+	m_cursor = m_anchor = 0;
+}
+
+void MpvFrameHistory::release() {
+	clear();
+	m_spare.clear();
+	m_spare.shrink_to_fit();
+	m_frames.shrink_to_fit();
+}
+
+const MpvFrameHistory::Frame *MpvFrameHistory::back() {
+	if (m_frames.empty() || m_cursor == 0) return nullptr;
+	return &m_frames[--m_cursor];
+}
+
+const MpvFrameHistory::Frame *MpvFrameHistory::forward() {
+	if (at_newest()) return nullptr;
+	return &m_frames[++m_cursor];
+}
+
+void MpvFrameHistory::anchor_at_cursor() {
+	while (!at_newest()) drop_back();
+	m_anchor = m_cursor;
+}
+
+MpvFrameHistory::Frame MpvFrameHistory::make_frame(const uint8_t *data, uint32_t width, uint32_t height, double time) {
+	Frame frame;
+	if (!m_spare.empty()) {
+		frame.data = std::move(m_spare.back());
+		m_spare.pop_back();
+	}
+	size_t bytes = (size_t)width * 4 * height;
+	frame.data.resize(bytes);
+	memcpy(frame.data.data(), data, bytes);
+	frame.width = width;
+	frame.height = height;
+	frame.time = time;
+	return frame;
+}
+
+void MpvFrameHistory::drop_front() {
+	recycle(m_frames.front());
+	m_frames.pop_front();
+	if (m_cursor > 0) m_cursor--;
+	if (m_anchor > 0) m_anchor--;
+}
+
+void MpvFrameHistory::drop_back() {
+	recycle(m_frames.back());
+	m_frames.pop_back();
+	size_t last = m_frames.empty() ? 0 : m_frames.size() - 1;
+	if (m_cursor > last) m_cursor = last;
+	if (m_anchor > last) m_anchor = last;
+}
+
+void MpvFrameHistory::recycle(Frame &frame) {
+	m_bytes -= frame.data.size();
+	// One spare is enough to recycle in steady state, where every push drops a frame
+	if (m_spare.empty()) m_spare.push_back(std::move(frame.data));
+}
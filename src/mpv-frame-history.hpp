@@ -0,0 +1,69 @@
+#pragma once
+
+// The last frames a source output, for stepping backward without decoding
+// again. Frames are kept in display order up to a byte limit (oldest dropped
+// first, buffers reused), each with mpv's time-pos when it went out.
+//
+// A cursor marks the frame on screen while stepping through the history
+// ("browsing"); the anchor is the frame mpv itself is on. They differ once
+// a step was served from here, and the owner has to seek mpv to the cursor
+// before it plays or decodes again.
+//
+// Not thread-safe; ObsMpvSource only uses it under its mpv lock.
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class MpvFrameHistory {
+public:
+	struct Frame {
+		std::vector<uint8_t> data; // BGRA
+		uint32_t width = 0;
+		uint32_t height = 0;
+		double time = 0.0;
+	};
+
+	void set_limit_mb(int mb); // 0 disables (and frees) the history
+	bool enabled() const { return m_limit > 0; }
+
+	// Appends after the newest frame, which becomes cursor and anchor
+	void push_back(const uint8_t *data, uint32_t width, uint32_t height, double time);
+	// Inserts before the oldest frame (mpv stepped back past it), which
+	// becomes cursor and anchor
+	void push_front(const uint8_t *data, uint32_t width, uint32_t height, double time);
+	void clear();
+	void release(); // clear() and free the spare buffer too
+
+	// Moves the cursor one frame and returns the frame to show, or null at
+	// the oldest / newest frame (the cursor stays)
+	const Frame *back();
+	const Frame *forward();
+
+	bool browsing() const { return m_cursor != m_anchor; }
+	const Frame *cursor() const { return m_frames.empty() ? nullptr : &m_frames[m_cursor]; }
+	const Frame *oldest() const { return m_frames.empty() ? nullptr : &m_frames.front(); }
+	const Frame *newest() const { return m_frames.empty() ? nullptr : &m_frames.back(); }
+	bool at_newest() const { return m_frames.empty() || m_cursor == m_frames.size() - 1; }
+
+	// Makes the cursor frame the one mpv is on and drops the frames after
+	// it, which mpv is about to decode again
+	void anchor_at_cursor();
+
+	size_t size() const { return m_frames.size(); }
+	size_t bytes() const { return m_bytes; }
+
+private:
+	std::deque<Frame> m_frames;
+	std::vector<std::vector<uint8_t>> m_spare; // Buffers of dropped frames
+	size_t m_bytes = 0;
+	size_t m_limit = 0;
+	size_t m_cursor = 0;
+	size_t m_anchor = 0;
+
+	Frame make_frame(const uint8_t *data, uint32_t width, uint32_t height, double time);
+	void drop_front();
+	void drop_back();
+	void recycle(Frame &frame);
+};
@@ -0,0 +1,89 @@
+#include "mpv-instance-budget.hpp"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+std::mutex g_budget_mutex;
+std::vector<MpvBudgetEntry *> g_live;
+int g_limit = 0;
+
+const char *const k_budget_file = "instance-budget.json";
+
+} // namespace
+
+bool mpv_budget_acquire(MpvBudgetEntry *entry) {
+	std::lock_guard<std::mutex> lock(g_budget_mutex);
+	if (std::find(g_live.begin(), g_live.end(), entry) != g_live.end()) return true;
+	entry->release_requested = false;
+
+	// Sources already asked to release count as gone
+	int staying = 0;
+	MpvBudgetEntry *victim = nullptr;
+	for (MpvBudgetEntry *e : g_live) {
+		if (e->release_requested) continue;
+		staying++;
+		uint64_t idle = e->idle_since_ns;
+		if (idle && (!victim || idle < victim->idle_since_ns)) victim = e;
+	}
+	if (g_limit > 0 && staying >= g_limit) {
+		if (!victim) {
+			obs_log(LOG_WARNING, "All %d mpv instances are in use; not starting another", g_limit);
+			return false;
+		}
+		victim->release_requested = true;
+	}
+	g_live.push_back(entry);
+	return true;
+}
+
+void mpv_budget_release(MpvBudgetEntry *entry) {
+	std::lock_guard<std::mutex> lock(g_budget_mutex);
+	g_live.erase(std::remove(g_live.begin(), g_live.end(), entry), g_live.end());
+	entry->release_requested = false;
+}
+
+int mpv_budget_live() {
+	std::lock_guard<std::mutex> lock(g_budget_mutex);
+	return (int)g_live.size();
+}
+
+int mpv_budget_limit() {
+	std::lock_guard<std::mutex> lock(g_budget_mutex);
+	return g_limit;
+}
+
+void mpv_budget_set_limit(int limit) {
+	std::lock_guard<std::mutex> lock(g_budget_mutex);
+	g_limit = std::max(limit, 0);
+	// Sources over a lowered limit wait until they go idle and are released
+	// by their own timeout or by the next source that needs room.
+}
+
+void mpv_budget_load() {
+	char *path = obs_module_config_path(k_budget_file);
+	obs_data_t *data = path ? obs_data_create_from_json_file_safe(path, "bak") : nullptr;
+	bfree(path);
+	if (!data) return;
+	mpv_budget_set_limit((int)obs_data_get_int(data, "max_live_instances"));
+	obs_data_release(data);
+}
+
+void mpv_budget_save() {
+	obs_data_t *data = obs_data_create();
+	obs_data_set_int(data, "max_live_instances", mpv_budget_limit());
+	char *dir = obs_module_config_path("");
+	if (dir) os_mkdirs(dir);
+	bfree(dir);
+	char *path = obs_module_config_path(k_budget_file);
+	if (!path || !obs_data_save_json_safe(data, path, "tmp", "bak"))
+		obs_log(LOG_WARNING, "Could not save the mpv instance limit to %s", path ? path : "(no config path)");
+	bfree(path);
+	obs_data_release(data);
+}
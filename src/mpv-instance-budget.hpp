@@ -0,0 +1,30 @@
+#pragma once
+
+// Plugin-wide count of live mpv instances (one per source that currently has
+// its mpv core, render context and threads), with an optional limit.
+//
+// A source that wants to create mpv while the limit is reached asks the live
+// source that has been idle the longest to release its instance; that source
+// does so on its next video tick, so the count may be one over the limit for
+// a frame. With no idle source to make room, creation is refused.
+
+#include <atomic>
+#include <cstdint>
+
+struct MpvBudgetEntry {
+	std::atomic<uint64_t> idle_since_ns{0};     // 0 while the source is in use
+	std::atomic<bool> release_requested{false}; // Set by the budget, cleared on release
+};
+
+// Registers entry as live. False when the limit is reached and no idle
+// source can make room.
+bool mpv_budget_acquire(MpvBudgetEntry *entry);
+void mpv_budget_release(MpvBudgetEntry *entry);
+
+int mpv_budget_live();
+int mpv_budget_limit(); // 0 = no limit
+void mpv_budget_set_limit(int limit);
+
+// The limit is kept in the plugin's config directory.
+void mpv_budget_load();
+void mpv_budget_save();
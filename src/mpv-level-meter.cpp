@@ -0,0 +1,63 @@
+#include "mpv-level-meter.hpp"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kFloorDb = -60.0f;
+
+// Position of a linear level on the meter, 0..1
+float meter_pos(float level) {
+	if (level <= 0.0f) return 0.0f;
+	float db = 20.0f * std::log10(level);
+	return std::clamp((db - kFloorDb) / -kFloorDb, 0.0f, 1.0f);
+}
+
+} // namespace
+
+MpvLevelMeter::MpvLevelMeter(QWidget *parent) : QWidget(parent) {
+	setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+	setToolTip("Output level per channel (RMS bar, peak tick), -60 to 0 dBFS");
+}
+
+void MpvLevelMeter::setLevels(int channels, const float *peak, const float *rms) {
+	channels = std::clamp(channels, 0, kMaxChannels);
+	bool changed = channels != m_channels;
+	for (int c = 0; c < channels; c++) {
+		changed = changed || peak[c] != m_peak[c] || rms[c] != m_rms[c];
+		m_peak[c] = peak[c];
+		m_rms[c] = rms[c];
+	}
+	if (channels != m_channels) updateGeometry();
+	m_channels = channels;
+	if (changed) update();
+}
+
+QSize MpvLevelMeter::sizeHint() const {
+	return QSize(200, std::max(m_channels, 2) * 5);
+}
+
+void MpvLevelMeter::paintEvent(QPaintEvent *) {
+	QPainter p(this);
+	p.fillRect(rect(), QColor(40, 40, 40));
+	if (m_channels == 0) return;
+
+	int w = width();
+	int bar = std::max(height() / m_channels, 1);
+	int warn = (int)(w * meter_pos(std::pow(10.0f, -18.0f / 20.0f)));
+	int clip = (int)(w * meter_pos(std::pow(10.0f, -6.0f / 20.0f)));
+	for (int c = 0; c < m_channels; c++) {
+		int y = c * bar;
+		int h = std::max(bar - 1, 1);
+		int rms = (int)(w * meter_pos(m_rms[c]));
+		p.fillRect(0, y, std::min(rms, warn), h, QColor(76, 175, 80));
+		if (rms > warn) p.fillRect(warn, y, std::min(rms, clip) - warn, h, QColor(255, 193, 7));
+		if (rms > clip) p.fillRect(clip, y, rms - clip, h, QColor(244, 67, 54));
+
+		int peak = (int)(w * meter_pos(m_peak[c]));
+		if (peak > 0) p.fillRect(std::min(peak, w - 2), y, 2, h, m_peak[c] >= 1.0f ? QColor(244, 67, 54) : QColor(Qt::white));
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QWidget>
+
+// Horizontal per-channel level meter for the dock: a bar for the RMS level
+// and a tick for the (falling) peak, on a -60..0 dBFS scale. Only paints
+// what it is given; ObsMpvSource::get_audio_levels() does the measuring.
+class MpvLevelMeter : public QWidget {
+public:
+	static constexpr int kMaxChannels = 8;
+
+	explicit MpvLevelMeter(QWidget *parent = nullptr);
+
+	// Linear levels (1.0 = full scale); channels = 0 shows an empty meter
+	void setLevels(int channels, const float *peak, const float *rms);
+
+	QSize sizeHint() const override;
+
+protected:
+	void paintEvent(QPaintEvent *event) override;
+
+private:
+	int m_channels = 0;
+	float m_peak[kMaxChannels] = {};
+	float m_rms[kMaxChannels] = {};
+};
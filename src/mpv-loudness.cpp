@@ -0,0 +1,156 @@
+#include "mpv-loudness.hpp"
+#include "mpv-trace.hpp"
+
+#include <mpv/client.h>
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Until the file is open, then a tenth of its duration on top: decoding audio
+// alone runs far faster than real time
+const uint64_t k_open_timeout_ns = 10000000000ULL;
+
+// Reads the ebur128 filter's metadata as of the last decoded frame, which
+// covers the whole file once it has reached EOF
+bool read_r128(mpv_handle *mpv, MpvLoudness &out) {
+	mpv_node node;
+	if (mpv_get_property(mpv, "af-metadata/r128", MPV_FORMAT_NODE, &node) < 0) return false;
+
+	bool have_i = false;
+	double peak = -1.0, peak_ch = 0.0;
+	if (node.format == MPV_FORMAT_NODE_MAP) {
+		for (int i = 0; i < node.u.list->num; i++) {
+			const char *key = node.u.list->keys[i];
+			const mpv_node &v = node.u.list->values[i];
+			if (v.format != MPV_FORMAT_STRING) continue;
+			double value = strtod(v.u.string, nullptr);
+			if (!strcmp(key, "lavfi.r128.I")) {
+				out.integrated_lufs = value;
+				have_i = true;
+			} else if (!strcmp(key, "lavfi.r128.true_peak")) {
+				peak = value;
+			} else if (!strncmp(key, "lavfi.r128.true_peaks_ch", 24)) {
+				peak_ch = std::max(peak_ch, value); // Older ffmpeg has only the per-channel peaks
+			}
+		}
+	}
+	mpv_free_node_contents(&node);
+
+	if (peak < 0.0) peak = peak_ch;
+	out.true_peak_db = peak > 0.0 ? std::max(20.0 * std::log10(peak), -100.0) : -100.0;
+	return have_i;
+}
+
+} // namespace
+
+double mpv_loudness_gain_db(const MpvLoudness &loudness, double target_lufs) {
+	if (loudness.integrated_lufs <= -70.0) return 0.0; // Silence: nothing passes the R128 gate
+	double gain = std::min(target_lufs - loudness.integrated_lufs, -1.0 - loudness.true_peak_db);
+	return std::clamp(gain, -20.0, 20.0);
+}
+
+MpvLoudnessAnalyzer &MpvLoudnessAnalyzer::instance() {
+	static MpvLoudnessAnalyzer analyzer;
+	return analyzer;
+}
+
+MpvLoudnessAnalyzer::~MpvLoudnessAnalyzer() { shutdown(); }
+
+void MpvLoudnessAnalyzer::request(const std::string &path) {
+	// Local files only: a stream or URL may never end, and is not worth
+	// downloading twice
+	if (!os_file_exists(path.c_str())) return;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_entries.count(path)) return;
+	m_entries[path].state = State::Pending;
+	m_queue.push(path);
+}
+
+bool MpvLoudnessAnalyzer::result(const std::string &path, MpvLoudness &out) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_entries.find(path);
+	if (it == m_entries.end() || it->second.state != State::Done) return false;
+	out = it->second.loudness;
+	return true;
+}
+
+void MpvLoudnessAnalyzer::shutdown() { m_queue.shutdown(); }
+
+void MpvLoudnessAnalyzer::run(const std::string &path) {
+	MPV_TRACE_SCOPE("loudness");
+	uint64_t start_ns = os_gettime_ns();
+	MpvLoudness loudness;
+	bool ok = measure(path, loudness, m_queue.tasks());
+	if (ok)
+		obs_log(LOG_INFO, "Loudness of %s: %.1f LUFS, true peak %.1f dBTP (%.0f ms)", path.c_str(),
+			loudness.integrated_lufs, loudness.true_peak_db, (os_gettime_ns() - start_ns) / 1e6);
+	else if (!m_queue.tasks().cancelled())
+		obs_log(LOG_WARNING, "Could not measure the loudness of %s", path.c_str());
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Entry &e = m_entries[path];
+		e.state = ok ? State::Done : State::Failed;
+		e.loudness = loudness;
+	}
+	m_revision++;
+}
+
+bool MpvLoudnessAnalyzer::measure(const std::string &path, MpvLoudness &out, const MpvTaskGroup &cancel) {
+	mpv_handle *mpv = mpv_create();
+	if (!mpv) return false;
+
+	// Audio only, decoded as fast as it goes, into nothing but the filter
+	mpv_set_option_string(mpv, "vo", "null");
+	mpv_set_option_string(mpv, "vid", "no");
+	mpv_set_option_string(mpv, "sid", "no");
+	mpv_set_option_string(mpv, "audio-display", "no");
+	mpv_set_option_string(mpv, "ao", "null");
+	mpv_set_option_string(mpv, "ao-null-untimed", "yes");
+	mpv_set_option_string(mpv, "af", "@r128:lavfi=[ebur128=metadata=1:peak=true]");
+	mpv_set_option_string(mpv, "keep-open", "yes"); // So the metadata can be read at EOF
+	mpv_set_option_string(mpv, "idle", "yes");
+	mpv_set_option_string(mpv, "load-scripts", "no");
+	mpv_set_option_string(mpv, "ytdl", "no");
+	if (mpv_initialize(mpv) < 0) {
+		mpv_terminate_destroy(mpv);
+		return false;
+	}
+	mpv_observe_property(mpv, 0, "eof-reached", MPV_FORMAT_FLAG);
+
+	const char *cmd[] = {"loadfile", path.c_str(), nullptr};
+	bool ok = false;
+	bool loaded = false;
+	uint64_t deadline = os_gettime_ns() + k_open_timeout_ns;
+	if (mpv_command(mpv, cmd) >= 0) {
+		while (!cancel.cancelled() && os_gettime_ns() < deadline) {
+			mpv_event *event = mpv_wait_event(mpv, 0.1);
+			if (event->event_id == MPV_EVENT_FILE_LOADED) {
+				int64_t aid = 0;
+				if (mpv_get_property(mpv, "aid", MPV_FORMAT_INT64, &aid) < 0) break; // No audio
+				double duration = 0.0;
+				if (mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration) < 0 || duration <= 0.0)
+					break; // Unknown length: would never reach EOF
+				deadline = os_gettime_ns() + k_open_timeout_ns + (uint64_t)(duration * 1e8);
+				loaded = true;
+			} else if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+				auto prop = static_cast<mpv_event_property *>(event->data);
+				if (loaded && prop->format == MPV_FORMAT_FLAG && *static_cast<int *>(prop->data)) {
+					ok = read_r128(mpv, out);
+					break;
+				}
+			} else if (event->event_id == MPV_EVENT_END_FILE || event->event_id == MPV_EVENT_SHUTDOWN) {
+				break;
+			}
+		}
+	}
+	mpv_terminate_destroy(mpv);
+	return ok;
+}
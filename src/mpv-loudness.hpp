@@ -0,0 +1,66 @@
+#pragma once
+
+// Offline EBU R128 loudness measurement for playlist items.
+//
+// A file is decoded audio-only and as fast as possible through ffmpeg's
+// ebur128 filter in a throwaway mpv instance (no audio device, no video),
+// and the integrated loudness and true peak of the whole file are read from
+// the filter's metadata at the end. None of this touches the playback path;
+// playback applies the result as a plain gain (mpv_audio_apply_gain).
+//
+// One file at a time plugin-wide, at background priority on the worker pool.
+
+#include "mpv-worker-pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct MpvLoudness {
+	double integrated_lufs = 0.0;
+	double true_peak_db = 0.0; // dBTP
+};
+
+// Gain in dB that brings the integrated loudness to target_lufs, limited to
+// +/-20 dB and so the true peak stays at or below -1 dBTP. 0 for silence.
+double mpv_loudness_gain_db(const MpvLoudness &loudness, double target_lufs);
+
+class MpvLoudnessAnalyzer {
+public:
+	static MpvLoudnessAnalyzer &instance();
+
+	// Queues path unless it is queued, measured or failed already, or not a
+	// local file. A measurement gives up if the file doesn't finish in time.
+	void request(const std::string &path);
+
+	// True once path has been measured; false while queued or if it failed.
+	bool result(const std::string &path, MpvLoudness &out);
+
+	// Bumped whenever a measurement finishes (or fails).
+	uint32_t revision() const { return m_revision; }
+
+	// Drops the queue and waits for the running measurement (module unload).
+	void shutdown();
+
+	// Decodes path on the calling thread; returns early once cancel is set.
+	static bool measure(const std::string &path, MpvLoudness &out, const MpvTaskGroup &cancel);
+
+private:
+	MpvLoudnessAnalyzer() = default;
+	~MpvLoudnessAnalyzer();
+
+	enum class State { Pending, Done, Failed };
+	struct Entry {
+		State state = State::Pending;
+		MpvLoudness loudness;
+	};
+
+	std::mutex m_mutex; // Guards m_entries
+	std::unordered_map<std::string, Entry> m_entries;
+	std::atomic<uint32_t> m_revision{0};
+	MpvSerialQueue<std::string> m_queue{MpvTaskPriority::Background, [this](std::string &path) { run(path); }};
+
+	void run(const std::string &path);
+};
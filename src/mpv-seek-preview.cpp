@@ -0,0 +1,93 @@
+#include "mpv-seek-preview.hpp"
+#include "mpv-trace.hpp"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+#include <algorithm>
+
+MpvSeekPreview &MpvSeekPreview::instance() {
+	static MpvSeekPreview preview;
+	return preview;
+}
+
+MpvSeekPreview::~MpvSeekPreview() { shutdown(); }
+
+void MpvSeekPreview::request(const std::string &path) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_indexes.count(path)) return;
+
+	FileIndex &index = m_indexes[path];
+	index.id = index.last_used = ++m_uses;
+	evict_locked();
+	m_queue.push(path);
+}
+
+std::shared_ptr<const MpvSeekFrame> MpvSeekPreview::frame_at(const std::string &path, double seconds) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_indexes.find(path);
+	if (it == m_indexes.end() || it->second.frames.empty()) return nullptr;
+	FileIndex &index = it->second;
+	index.last_used = ++m_uses;
+
+	auto next = std::upper_bound(index.frames.begin(), index.frames.end(), seconds,
+				     [](double t, const std::shared_ptr<const MpvSeekFrame> &f) { return t < f->time; });
+	return next == index.frames.begin() ? *next : *(next - 1);
+}
+
+void MpvSeekPreview::shutdown() {
+	m_queue.shutdown();
+	m_grabber.close();
+}
+
+void MpvSeekPreview::build(const std::string &path) {
+	MPV_TRACE_SCOPE("seek_index");
+	uint64_t start_ns = os_gettime_ns();
+	int entries = 0;
+	uint64_t id;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_indexes.find(path);
+		if (it == m_indexes.end()) return; // Evicted while queued
+		id = it->second.id;
+	}
+
+	const MpvTaskGroup &cancel = m_queue.tasks();
+	if (m_grabber.load(path, "none", cancel)) {
+		double duration = m_grabber.duration();
+		int steps = std::clamp((int)(duration / 2.0), 1, kSteps);
+		double last = -1.0;
+		for (int i = 0; i < steps && !cancel.cancelled(); i++) {
+			if (i > 0 && !m_grabber.seek_keyframe(duration * i / steps, cancel)) continue;
+			double t = m_grabber.time_pos();
+			if (t <= last) continue; // Same keyframe as the previous target
+
+			auto frame = std::make_shared<MpvSeekFrame>();
+			frame->time = std::max(t, 0.0);
+			if (!m_grabber.grab(MpvSeekFrame::kWidth, MpvSeekFrame::kHeight, frame->bgra)) continue;
+			last = t;
+			entries++;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_indexes.find(path);
+			if (it == m_indexes.end() || it->second.id != id) return; // Evicted meanwhile
+			it->second.frames.push_back(std::move(frame));
+		}
+	}
+
+	obs_log(LOG_DEBUG, "Seek preview index for %s: %d keyframes in %.0f ms", path.c_str(), entries,
+		(os_gettime_ns() - start_ns) / 1e6);
+}
+
+void MpvSeekPreview::evict_locked() {
+	// Least recently used first; an index still waiting or being built is
+	// dropped too, and its job stops at its next entry
+	while (m_indexes.size() > kMaxFiles) {
+		auto victim = m_indexes.end();
+		for (auto it = m_indexes.begin(); it != m_indexes.end(); ++it)
+			if (victim == m_indexes.end() || it->second.last_used < victim->second.last_used) victim = it;
+		m_queue.remove_if([&](const std::string &path) { return path == victim->first; });
+		m_indexes.erase(victim);
+	}
+}
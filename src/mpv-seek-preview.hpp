@@ -0,0 +1,72 @@
+#pragma once
+
+// Scrub previews for the dock's seek slider.
+//
+// The first time the seek slider is hovered or dragged for a file, a
+// background job walks it with keyframe seeks at evenly spaced targets
+// (every 2 s, at most kSteps). Each lands on the keyframe at or before its
+// target, whose timestamp and a small frame go into the file's index;
+// targets that land on the same keyframe share an entry. Hovering or
+// dragging then only looks up the entry at or before the position: no
+// decoding, and the playing mpv instance is never touched.
+// Entries become usable while the index is still being built.
+//
+// Indexes are built one at a time at background priority on the worker
+// pool, with an MpvFrameGrabber, and only for files someone scrubs. The last
+// kMaxFiles indexes are kept in memory.
+
+#include "mpv-thumbnails.hpp"
+#include "mpv-worker-pool.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct MpvSeekFrame {
+	static constexpr int kWidth = 128;
+	static constexpr int kHeight = 72;
+	double time = 0.0; // Keyframe timestamp, seconds
+	std::vector<uint8_t> bgra;
+};
+
+class MpvSeekPreview {
+public:
+	static constexpr int kSteps = 100;
+	static constexpr size_t kMaxFiles = 4; // ~3.7 MB each when full
+
+	static MpvSeekPreview &instance();
+
+	// Queues building the index for path unless it exists or is queued.
+	void request(const std::string &path);
+
+	// The frame of the keyframe at or before seconds (the first one before
+	// that); null when nothing is indexed yet.
+	std::shared_ptr<const MpvSeekFrame> frame_at(const std::string &path, double seconds);
+
+	// Drops the queue and waits for the running job (module unload).
+	void shutdown();
+
+private:
+	MpvSeekPreview() = default;
+	~MpvSeekPreview();
+
+	struct FileIndex {
+		std::vector<std::shared_ptr<const MpvSeekFrame>> frames; // Ascending time
+		uint64_t id = 0; // Tells a rebuilt index from one evicted during its build
+		uint64_t last_used = 0;
+	};
+
+	std::mutex m_mutex; // Guards the indexes
+	std::unordered_map<std::string, FileIndex> m_indexes;
+	uint64_t m_uses = 0;
+
+	MpvFrameGrabber m_grabber; // Only touched by the one running job
+	MpvSerialQueue<std::string> m_queue{MpvTaskPriority::Background, [this](std::string &path) { build(path); },
+					    [this] { m_grabber.close(); }};
+
+	void build(const std::string &path);
+	void evict_locked();
+};
@@ -0,0 +1,280 @@
+#include "mpv-thumbnails.hpp"
+#include "mpv-trace.hpp"
+
+#include <mpv/client.h>
+#include <mpv/render.h>
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+const size_t k_max_resident = 512; // Ready thumbnails kept in memory (~10 MB)
+const size_t k_max_on_disk = 2048; // Cache files kept (~42 MB)
+const unsigned k_prune_every = 64; // Cache writes between disk cache prunes
+const uint64_t k_render_timeout_ns = 5000000000ULL;
+const char k_magic[4] = {'M', 'P', 'V', 'T'};
+
+uint64_t fnv1a(const void *data, size_t len, uint64_t h = 14695981039346656037ULL) {
+	auto p = static_cast<const uint8_t *>(data);
+	for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 1099511628211ULL;
+	return h;
+}
+
+std::filesystem::path to_fs_path(const std::string &utf8) { return std::u8string(utf8.begin(), utf8.end()); }
+
+// Cache file for path as it is now; empty when the file cannot be stat'ed or
+// there is no config directory
+std::string cache_file(const std::string &path) {
+	std::error_code ec;
+	std::filesystem::path fs_path = to_fs_path(path);
+	uint64_t size = std::filesystem::file_size(fs_path, ec);
+	if (ec) return {};
+	int64_t mtime = (int64_t)std::filesystem::last_write_time(fs_path, ec).time_since_epoch().count();
+	if (ec) return {};
+
+	uint64_t h = fnv1a(path.data(), path.size());
+	h = fnv1a(&size, sizeof(size), h);
+	h = fnv1a(&mtime, sizeof(mtime), h);
+	char name[64];
+	snprintf(name, sizeof(name), "thumbnails/%016" PRIx64 ".thumb", h);
+	char *file = obs_module_config_path(name);
+	std::string out = file ? file : "";
+	bfree(file);
+	return out;
+}
+
+std::shared_ptr<MpvThumbnail> read_cached(const std::string &file) {
+	FILE *f = os_fopen(file.c_str(), "rb");
+	if (!f) return nullptr;
+	auto thumb = std::make_shared<MpvThumbnail>();
+	thumb->bgra.resize((size_t)MpvThumbnail::kWidth * MpvThumbnail::kHeight * 4);
+	char magic[4];
+	uint32_t dims[2];
+	bool ok = fread(magic, 1, 4, f) == 4 && !memcmp(magic, k_magic, 4) && fread(dims, sizeof(dims), 1, f) == 1 &&
+		  dims[0] == MpvThumbnail::kWidth && dims[1] == MpvThumbnail::kHeight &&
+		  fread(thumb->bgra.data(), 1, thumb->bgra.size(), f) == thumb->bgra.size();
+	fclose(f);
+	if (!ok) return nullptr;
+	// Pruning goes by mtime, so a file still in use counts as fresh
+	std::error_code ec;
+	std::filesystem::last_write_time(to_fs_path(file), std::filesystem::file_time_type::clock::now(), ec);
+	return thumb;
+}
+
+void write_cached(const std::string &file, const MpvThumbnail &thumb) {
+	char *dir = obs_module_config_path("thumbnails");
+	if (dir) os_mkdirs(dir);
+	bfree(dir);
+	FILE *f = os_fopen(file.c_str(), "wb");
+	if (!f) return;
+	uint32_t dims[2] = {MpvThumbnail::kWidth, MpvThumbnail::kHeight};
+	bool ok = fwrite(k_magic, 1, 4, f) == 4 && fwrite(dims, sizeof(dims), 1, f) == 1 &&
+		  fwrite(thumb.bgra.data(), 1, thumb.bgra.size(), f) == thumb.bgra.size();
+	fclose(f);
+	if (!ok) os_unlink(file.c_str());
+}
+
+// Every edited or replaced file leaves its old cache file behind; keep the
+// k_max_on_disk most recently used ones
+void prune_cached() {
+	char *dir = obs_module_config_path("thumbnails");
+	if (!dir) return;
+	std::filesystem::path fs_dir = to_fs_path(dir);
+	bfree(dir);
+
+	std::error_code ec;
+	std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+	for (auto it = std::filesystem::directory_iterator(fs_dir, ec); !ec && it != std::filesystem::directory_iterator();
+	     it.increment(ec)) {
+		if (it->path().extension() != ".thumb") continue;
+		auto mtime = it->last_write_time(ec);
+		if (!ec) files.emplace_back(mtime, it->path());
+	}
+	if (files.size() <= k_max_on_disk) return;
+
+	std::sort(files.begin(), files.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+	for (size_t i = k_max_on_disk; i < files.size(); i++) std::filesystem::remove(files[i].second, ec);
+	obs_log(LOG_DEBUG, "Pruned %zu thumbnail cache files", files.size() - k_max_on_disk);
+}
+
+} // namespace
+
+MpvThumbnailCache &MpvThumbnailCache::instance() {
+	static MpvThumbnailCache cache;
+	return cache;
+}
+
+MpvThumbnailCache::~MpvThumbnailCache() { shutdown(); }
+
+std::shared_ptr<const MpvThumbnail> MpvThumbnailCache::get(const std::string &path, bool still) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_entries.find(path);
+	if (it != m_entries.end()) {
+		Entry &e = it->second;
+		if (e.state == State::Ready) m_lru.splice(m_lru.begin(), m_lru, e.lru);
+		return e.thumb;
+	}
+
+	m_entries[path].state = State::Pending;
+	m_queue.push({path, still});
+	return nullptr;
+}
+
+void MpvThumbnailCache::shutdown() {
+	m_queue.shutdown();
+	m_grabber.close();
+}
+
+void MpvThumbnailCache::make(const Job &job) {
+	const std::string &path = job.first;
+
+	std::string file = cache_file(path);
+	std::shared_ptr<MpvThumbnail> thumb = file.empty() ? nullptr : read_cached(file);
+	if (!thumb) {
+		MPV_TRACE_SCOPE("thumbnail");
+		thumb = std::make_shared<MpvThumbnail>();
+		if (!m_grabber.load(path, job.second ? "none" : "10%", m_queue.tasks()) ||
+		    !m_grabber.grab(MpvThumbnail::kWidth, MpvThumbnail::kHeight, thumb->bgra)) {
+			obs_log(LOG_DEBUG, "No thumbnail for %s", path.c_str());
+			thumb = nullptr;
+		}
+		if (thumb && !file.empty()) {
+			write_cached(file, *thumb);
+			if (m_disk_writes++ % k_prune_every == 0) prune_cached();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_entries.find(path);
+		if (it != m_entries.end()) {
+			Entry &e = it->second;
+			e.thumb = thumb;
+			e.state = thumb ? State::Ready : State::Failed;
+			if (thumb) {
+				m_lru.push_front(path);
+				e.lru = m_lru.begin();
+				evict_locked();
+			}
+		}
+	}
+	m_revision++;
+}
+
+void MpvThumbnailCache::evict_locked() {
+	// Evicted entries are forgotten entirely; asking again reloads from disk
+	while (m_lru.size() > k_max_resident) {
+		m_entries.erase(m_lru.back());
+		m_lru.pop_back();
+	}
+}
+
+bool MpvFrameGrabber::open() {
+	if (m_mpv) return true;
+	m_mpv = mpv_create();
+	if (!m_mpv) return false;
+
+	mpv_set_option_string(m_mpv, "vo", "libmpv");
+	mpv_set_option_string(m_mpv, "ao", "null");
+	mpv_set_option_string(m_mpv, "aid", "no");
+	mpv_set_option_string(m_mpv, "sid", "no");
+	mpv_set_option_string(m_mpv, "hwdec", "no");
+	mpv_set_option_string(m_mpv, "vd-lavc-threads", "1");
+	mpv_set_option_string(m_mpv, "vd-lavc-skiploopfilter", "all");
+	mpv_set_option_string(m_mpv, "vd-lavc-fast", "yes");
+	mpv_set_option_string(m_mpv, "sws-fast", "yes");
+	mpv_set_option_string(m_mpv, "hr-seek", "no");
+	mpv_set_option_string(m_mpv, "cache", "no");
+	mpv_set_option_string(m_mpv, "pause", "yes");
+	mpv_set_option_string(m_mpv, "idle", "yes");
+	mpv_set_option_string(m_mpv, "load-scripts", "no");
+	mpv_set_option_string(m_mpv, "ytdl", "no");
+	if (mpv_initialize(m_mpv) < 0) {
+		close();
+		return false;
+	}
+
+	mpv_render_param p[] = {{MPV_RENDER_PARAM_API_TYPE, (void *)MPV_RENDER_API_TYPE_SW},
+				{MPV_RENDER_PARAM_INVALID, nullptr}};
+	if (mpv_render_context_create(&m_render, m_mpv, p) < 0) {
+		m_render = nullptr;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MpvFrameGrabber::close() {
+	if (m_render) mpv_render_context_free(m_render);
+	m_render = nullptr;
+	if (m_mpv) mpv_terminate_destroy(m_mpv);
+	m_mpv = nullptr;
+}
+
+bool MpvFrameGrabber::load(const std::string &path, const char *start, const MpvTaskGroup &cancel) {
+	if (!open()) return false;
+	// start is a global option, so it is set again for every file
+	mpv_set_property_string(m_mpv, "start", start);
+	const char *cmd[] = {"loadfile", path.c_str(), nullptr};
+	if (mpv_command(m_mpv, cmd) < 0) return false;
+	return wait_frame(cancel);
+}
+
+bool MpvFrameGrabber::seek_keyframe(double seconds, const MpvTaskGroup &cancel) {
+	// A plain time-pos seek; with hr-seek=no it stops at the keyframe
+	if (!m_mpv || mpv_set_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &seconds) < 0) return false;
+	return wait_frame(cancel);
+}
+
+bool MpvFrameGrabber::wait_frame(const MpvTaskGroup &cancel) {
+	bool restarted = false;
+	uint64_t deadline = os_gettime_ns() + k_render_timeout_ns;
+	while (os_gettime_ns() < deadline && !cancel.cancelled()) {
+		mpv_event *event = mpv_wait_event(m_mpv, 0.02);
+		if (event->event_id == MPV_EVENT_FILE_LOADED) {
+			int64_t vid = 0;
+			if (mpv_get_property(m_mpv, "vid", MPV_FORMAT_INT64, &vid) < 0) return false; // Audio only
+		} else if (event->event_id == MPV_EVENT_PLAYBACK_RESTART) {
+			restarted = true;
+		} else if (event->event_id == MPV_EVENT_SHUTDOWN) {
+			return false;
+		} else if (event->event_id == MPV_EVENT_END_FILE &&
+			   static_cast<mpv_event_end_file *>(event->data)->reason == MPV_END_FILE_REASON_ERROR) {
+			return false; // The previous file ends with reason STOP when this one replaces it
+		}
+		if (restarted && (mpv_render_context_update(m_render) & MPV_RENDER_UPDATE_FRAME)) return true;
+	}
+	return false;
+}
+
+bool MpvFrameGrabber::grab(int width, int height, std::vector<uint8_t> &bgra) {
+	if (!m_render) return false;
+	bgra.resize((size_t)width * height * 4);
+	int size[2] = {width, height};
+	size_t stride = (size_t)width * 4;
+	mpv_render_param p[] = {{MPV_RENDER_PARAM_SW_SIZE, size},
+				{MPV_RENDER_PARAM_SW_FORMAT, (void *)"bgra"},
+				{MPV_RENDER_PARAM_SW_STRIDE, &stride},
+				{MPV_RENDER_PARAM_SW_POINTER, bgra.data()},
+				{MPV_RENDER_PARAM_INVALID, nullptr}};
+	return mpv_render_context_render(m_render, p) >= 0;
+}
+
+double MpvFrameGrabber::time_pos() {
+	double t = -1.0;
+	if (m_mpv) mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &t);
+	return t;
+}
+
+double MpvFrameGrabber::duration() {
+	double d = 0.0;
+	if (m_mpv) mpv_get_property(m_mpv, "duration", MPV_FORMAT_DOUBLE, &d);
+	return d;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+// Small preview images for playlist rows, made in the background.
+//
+// A thumbnail is the frame at 10% into the file (the nearest keyframe, no
+// exact seek), rendered by an MpvFrameGrabber straight to kWidth x kHeight
+// and cached on disk in the plugin config directory, keyed by path,
+// size and modification time, so a file is decoded once until it changes.
+// The disk cache is pruned to the most recently used files as it grows.
+//
+// To stay out of the way of playback, at most one thumbnail is made at a
+// time plugin-wide, as a background-priority task on the worker pool.
+
+#include "mpv-worker-pool.hpp"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct mpv_handle;
+struct mpv_render_context;
+
+// A paused, cheap mpv instance that renders single frames to small BGRA
+// images: one software decoder thread, no hwdec, audio or subtitles, and
+// keyframe-only seeks. Used by one job at a time.
+class MpvFrameGrabber {
+public:
+	~MpvFrameGrabber() { close(); }
+
+	// Opens path at start (an mpv "start" value such as "10%" or "none") and
+	// waits for the first frame. False for files without video, on errors,
+	// on timeout or once cancel is set.
+	bool load(const std::string &path, const char *start, const MpvTaskGroup &cancel);
+	// Seeks to the keyframe at or before seconds and waits for its frame
+	bool seek_keyframe(double seconds, const MpvTaskGroup &cancel);
+	// Renders the current frame letterboxed into width x height BGRA
+	bool grab(int width, int height, std::vector<uint8_t> &bgra);
+	double time_pos();
+	double duration();
+	void close();
+
+private:
+	mpv_handle *m_mpv = nullptr;
+	mpv_render_context *m_render = nullptr;
+	bool open();
+	bool wait_frame(const MpvTaskGroup &cancel);
+};
+
+struct MpvThumbnail {
+	static constexpr int kWidth = 96;
+	static constexpr int kHeight = 54;
+	std::vector<uint8_t> bgra; // kWidth * kHeight * 4, letterboxed
+};
+
+class MpvThumbnailCache {
+public:
+	static MpvThumbnailCache &instance();
+
+	// The thumbnail for path if it is ready. Otherwise null, and it is
+	// queued (once) to be loaded from disk or generated. Stills are shown
+	// whole instead of seeking into them.
+	std::shared_ptr<const MpvThumbnail> get(const std::string &path, bool still);
+
+	// Bumped whenever a queued thumbnail is done (or failed).
+	uint32_t revision() const { return m_revision; }
+
+	// Drops the queue and waits for the running job (module unload).
+	void shutdown();
+
+private:
+	MpvThumbnailCache() = default;
+	~MpvThumbnailCache();
+
+	enum class State { Pending, Ready, Failed };
+	struct Entry {
+		State state = State::Pending;
+		std::shared_ptr<const MpvThumbnail> thumb;
+		std::list<std::string>::iterator lru;
+	};
+
+	std::mutex m_mutex; // Guards the entries and the LRU list
+	std::unordered_map<std::string, Entry> m_entries;
+	std::list<std::string> m_lru; // Ready entries, most recently used first
+	std::atomic<uint32_t> m_revision{0};
+
+	MpvFrameGrabber m_grabber; // Only touched by the one running job
+	unsigned m_disk_writes = 0; // Likewise
+	using Job = std::pair<std::string, bool>; // Path, still
+	MpvSerialQueue<Job> m_queue{MpvTaskPriority::Background, [this](Job &job) { make(job); },
+				    [this] { m_grabber.close(); }};
+
+	void make(const Job &job);
+	void evict_locked();
+};
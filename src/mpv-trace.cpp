@@ -0,0 +1,164 @@
+#include "mpv-trace.hpp"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_mpv_trace_enabled{false};
+
+namespace {
+
+struct TraceEvent {
+	const char *name;
+	uint64_t begin_ns;
+	uint64_t end_ns; // 0 for instant events
+	int64_t arg;
+};
+
+// Single writer (the owning thread), read only by mpv_trace_dump after
+// recording stops. head counts every event ever written; the ring keeps the
+// most recent kCapacity of them.
+struct ThreadBuffer {
+	static constexpr size_t kCapacity = 1 << 15;
+
+	int tid = 0;
+	std::atomic<const char *> name{nullptr};
+	std::atomic<bool> owned{false};
+	std::atomic<uint64_t> head{0};
+	TraceEvent events[kCapacity];
+};
+
+std::mutex g_registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+int g_next_tid = 1;
+std::atomic<uint64_t> g_epoch_ns{0};
+
+// Releases the buffer for reuse by a later thread once it has been cleared.
+struct ThreadSlot {
+	ThreadBuffer *buf = nullptr;
+	const char *name = nullptr;
+	~ThreadSlot() {
+		if (buf) buf->owned.store(false, std::memory_order_release);
+	}
+};
+
+thread_local ThreadSlot t_slot;
+
+ThreadBuffer *thread_buffer() {
+	if (t_slot.buf) return t_slot.buf;
+
+	std::lock_guard<std::mutex> lock(g_registry_mutex);
+	ThreadBuffer *buf = nullptr;
+	for (auto &b : g_buffers) {
+		if (!b->owned.load(std::memory_order_acquire) && b->head.load(std::memory_order_relaxed) == 0) {
+			buf = b.get();
+			break;
+		}
+	}
+	if (!buf) {
+		g_buffers.push_back(std::make_unique<ThreadBuffer>());
+		buf = g_buffers.back().get();
+	}
+	buf->tid = g_next_tid++;
+	buf->name.store(t_slot.name, std::memory_order_relaxed);
+	buf->owned.store(true, std::memory_order_relaxed);
+	t_slot.buf = buf;
+	return buf;
+}
+
+void record(const char *name, uint64_t begin_ns, uint64_t end_ns, int64_t arg) {
+	ThreadBuffer *buf = thread_buffer();
+	uint64_t h = buf->head.load(std::memory_order_relaxed);
+	buf->events[h % ThreadBuffer::kCapacity] = {name, begin_ns, end_ns, arg};
+	buf->head.store(h + 1, std::memory_order_release);
+}
+
+} // namespace
+
+void mpv_trace_start() {
+	g_mpv_trace_enabled.store(false, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(g_registry_mutex);
+		for (auto &b : g_buffers) b->head.store(0, std::memory_order_relaxed);
+	}
+	g_epoch_ns.store(os_gettime_ns(), std::memory_order_relaxed);
+	g_mpv_trace_enabled.store(true, std::memory_order_release);
+	obs_log(LOG_INFO, "Tracing started");
+}
+
+void mpv_trace_stop() { g_mpv_trace_enabled.store(false, std::memory_order_release); }
+
+void mpv_trace_thread_name(const char *name) {
+	t_slot.name = name;
+	if (t_slot.buf) t_slot.buf->name.store(name, std::memory_order_relaxed);
+}
+
+void mpv_trace_span(const char *name, uint64_t begin_ns, uint64_t end_ns, int64_t arg) {
+	if (!mpv_trace_active()) return;
+	record(name, begin_ns, end_ns > begin_ns ? end_ns : begin_ns + 1, arg);
+}
+
+void mpv_trace_instant(const char *name, int64_t arg) {
+	if (!mpv_trace_active()) return;
+	record(name, os_gettime_ns(), 0, arg);
+}
+
+bool mpv_trace_dump(const char *path) {
+	mpv_trace_stop();
+
+	FILE *f = fopen(path, "w");
+	if (!f) {
+		obs_log(LOG_WARNING, "Could not open trace file %s", path);
+		return false;
+	}
+
+	const uint64_t epoch = g_epoch_ns.load(std::memory_order_relaxed);
+	size_t written = 0;
+	bool first = true;
+	auto sep = [&]() {
+		fputs(first ? "\n" : ",\n", f);
+		first = false;
+	};
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+	std::lock_guard<std::mutex> lock(g_registry_mutex);
+	for (auto &b : g_buffers) {
+		uint64_t head = b->head.load(std::memory_order_acquire);
+		if (head == 0) continue;
+
+		const char *name = b->name.load(std::memory_order_relaxed);
+		sep();
+		fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", b->tid,
+			name ? name : "thread");
+
+		// A write that raced the stop may be landing on the oldest slot of a
+		// wrapped ring, so skip that one.
+		uint64_t begin = head > ThreadBuffer::kCapacity ? head - ThreadBuffer::kCapacity + 1 : 0;
+		for (uint64_t i = begin; i < head; i++) {
+			const TraceEvent &ev = b->events[i % ThreadBuffer::kCapacity];
+			if (ev.begin_ns < epoch) continue;
+			double ts = (ev.begin_ns - epoch) / 1000.0;
+			sep();
+			if (ev.end_ns) {
+				fprintf(f,
+					"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+					"\"args\":{\"v\":%lld}}",
+					ev.name, b->tid, ts, (ev.end_ns - ev.begin_ns) / 1000.0, (long long)ev.arg);
+			} else {
+				fprintf(f,
+					"{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+					"\"args\":{\"v\":%lld}}",
+					ev.name, b->tid, ts, (long long)ev.arg);
+			}
+			written++;
+		}
+	}
+	fputs("\n]}\n", f);
+	bool ok = fclose(f) == 0;
+	obs_log(LOG_INFO, "Wrote %zu trace events to %s", written, path);
+	return ok;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// Optional span tracing for the playback pipeline, exported as Chrome
+// trace-event JSON (load it in chrome://tracing or ui.perfetto.dev).
+//
+// Each thread records into its own fixed-size ring buffer, so recording is a
+// couple of stores with no locks. While tracing is off, a scope costs one
+// relaxed atomic load. Event names must be string literals.
+
+#include <atomic>
+#include <cstdint>
+#include <util/platform.h>
+
+extern std::atomic<bool> g_mpv_trace_enabled;
+
+static inline bool mpv_trace_active() { return g_mpv_trace_enabled.load(std::memory_order_relaxed); }
+
+// Clears previously recorded events and starts recording.
+void mpv_trace_start();
+void mpv_trace_stop();
+
+// Stops recording and writes everything captured so far to path.
+bool mpv_trace_dump(const char *path);
+
+// Names the calling thread in the exported timeline. Cheap; may be called
+// repeatedly from threads the plugin does not own (e.g. the OBS video tick).
+void mpv_trace_thread_name(const char *name);
+
+void mpv_trace_span(const char *name, uint64_t begin_ns, uint64_t end_ns, int64_t arg = 0);
+void mpv_trace_instant(const char *name, int64_t arg = 0);
+
+class MpvTraceScope {
+public:
+	explicit MpvTraceScope(const char *name, int64_t arg = 0) : m_name(name), m_arg(arg) {
+		if (mpv_trace_active()) m_begin = os_gettime_ns();
+	}
+	~MpvTraceScope() {
+		if (m_begin) mpv_trace_span(m_name, m_begin, os_gettime_ns(), m_arg);
+	}
+	MpvTraceScope(const MpvTraceScope &) = delete;
+	MpvTraceScope &operator=(const MpvTraceScope &) = delete;
+
+	void set_arg(int64_t arg) { m_arg = arg; }
+
+private:
+	const char *m_name;
+	int64_t m_arg;
+	uint64_t m_begin = 0;
+};
+
+#define MPV_TRACE_CONCAT2(a, b) a##b
+#define MPV_TRACE_CONCAT(a, b) MPV_TRACE_CONCAT2(a, b)
+#define MPV_TRACE_SCOPE(...) MpvTraceScope MPV_TRACE_CONCAT(mpv_trace_scope_, __LINE__)(__VA_ARGS__)
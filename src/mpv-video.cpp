@@ -0,0 +1,113 @@
+#include "mpv-video.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MPV_VIDEO_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MPV_VIDEO_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(MPV_VIDEO_SSE2)
+static size_t blend_simd(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t bytes, int wb) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i wa16 = _mm_set1_epi16((short)(256 - wb));
+	const __m128i wb16 = _mm_set1_epi16((short)wb);
+	size_t i = 0;
+	for (; i + 16 <= bytes; i += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa16),
+					   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb16));
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa16),
+					   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb16));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+	}
+	return i;
+}
+#elif defined(MPV_VIDEO_NEON)
+static size_t blend_simd(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t bytes, int wb) {
+	const uint8x8_t wa8 = vdup_n_u8((uint8_t)(256 - wb));
+	const uint8x8_t wb8 = vdup_n_u8((uint8_t)wb);
+	size_t i = 0;
+	for (; i + 16 <= bytes; i += 16) {
+		uint8x16_t va = vld1q_u8(a + i);
+		uint8x16_t vb = vld1q_u8(b + i);
+		uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(va), wa8), vget_low_u8(vb), wb8);
+		uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(va), wa8), vget_high_u8(vb), wb8);
+		vst1q_u8(dst + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+	}
+	return i;
+}
+#else
+static size_t blend_simd(const uint8_t *, const uint8_t *, uint8_t *, size_t, int) { return 0; }
+#endif
+
+// Fletcher-style sums over 32-bit lanes: a is the plain sum, b the running sum
+// of a, which makes the result depend on where in the row a byte changed.
+#if defined(MPV_VIDEO_SSE2)
+static size_t row_sums_simd(const uint8_t *row, size_t bytes, uint32_t &a_out, uint32_t &b_out) {
+	__m128i a = _mm_setzero_si128();
+	__m128i b = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 16 <= bytes; i += 16) {
+		a = _mm_add_epi32(a, _mm_loadu_si128((const __m128i *)(row + i)));
+		b = _mm_add_epi32(b, a);
+	}
+	uint32_t la[4], lb[4];
+	_mm_storeu_si128((__m128i *)la, a);
+	_mm_storeu_si128((__m128i *)lb, b);
+	a_out = la[0] ^ (la[1] * 3) ^ (la[2] * 5) ^ (la[3] * 7);
+	b_out = lb[0] ^ (lb[1] * 3) ^ (lb[2] * 5) ^ (lb[3] * 7);
+	return i;
+}
+#elif defined(MPV_VIDEO_NEON)
+static size_t row_sums_simd(const uint8_t *row, size_t bytes, uint32_t &a_out, uint32_t &b_out) {
+	uint32x4_t a = vdupq_n_u32(0);
+	uint32x4_t b = vdupq_n_u32(0);
+	size_t i = 0;
+	for (; i + 16 <= bytes; i += 16) {
+		a = vaddq_u32(a, vreinterpretq_u32_u8(vld1q_u8(row + i)));
+		b = vaddq_u32(b, a);
+	}
+	a_out = vgetq_lane_u32(a, 0) ^ (vgetq_lane_u32(a, 1) * 3) ^ (vgetq_lane_u32(a, 2) * 5) ^ (vgetq_lane_u32(a, 3) * 7);
+	b_out = vgetq_lane_u32(b, 0) ^ (vgetq_lane_u32(b, 1) * 3) ^ (vgetq_lane_u32(b, 2) * 5) ^ (vgetq_lane_u32(b, 3) * 7);
+	return i;
+}
+#else
+static size_t row_sums_simd(const uint8_t *, size_t, uint32_t &a_out, uint32_t &b_out) {
+	a_out = b_out = 0;
+	return 0;
+}
+#endif
+
+void mpv_video_blend(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t bytes, int weight_b) {
+	if (weight_b <= 0) {
+		if (dst != a) memcpy(dst, a, bytes);
+		return;
+	}
+	if (weight_b >= 256) {
+		if (dst != b) memcpy(dst, b, bytes);
+		return;
+	}
+	size_t i = blend_simd(a, b, dst, bytes, weight_b);
+	for (; i < bytes; i++) dst[i] = (uint8_t)((a[i] * (256 - weight_b) + b[i] * weight_b) >> 8);
+}
+
+uint64_t mpv_video_hash(const uint8_t *data, size_t stride, size_t row_bytes, uint32_t rows, uint32_t row_step) {
+	uint64_t h = 14695981039346656037ULL; // FNV-1a offset basis
+	if (row_step == 0) row_step = 1;
+	for (uint32_t y = 0; y < rows; y += row_step) {
+		const uint8_t *row = data + (size_t)y * stride;
+		uint32_t a, b;
+		size_t i = row_sums_simd(row, row_bytes, a, b);
+		for (; i < row_bytes; i++) {
+			a += row[i];
+			b += a;
+		}
+		h = (h ^ (((uint64_t)b << 32) | a)) * 1099511628211ULL;
+	}
+	return h;
+}
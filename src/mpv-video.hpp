@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// dst = a * (256 - weight_b) / 256 + b * weight_b / 256 for every byte.
+// weight_b is 0..256; works on any packed 8-bit format (BGRA here).
+void mpv_video_blend(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t bytes, int weight_b);
+
+// Cheap change detector for rendered frames: hashes every row_step-th row
+// (whole rows, so narrow changes across a sampled row are caught). Not a
+// cryptographic hash; it only tells "same picture" from "new picture".
+uint64_t mpv_video_hash(const uint8_t *data, size_t stride, size_t row_bytes, uint32_t rows, uint32_t row_step);
+
+// Snaps display times onto the OBS canvas frame grid, so a source running at
+// its own rate lands on whole canvas frames with a stable pulldown cadence.
+struct MpvCanvasClock {
+	uint64_t interval_ns = 0; // One canvas frame
+	uint64_t origin_ns = 0;   // Earliest canvas frame time on the clock
+
+	// origin is any canvas frame time, e.g. obs_get_video_frame_time()
+	void reset(uint32_t fps_num, uint32_t fps_den, uint64_t origin) {
+		interval_ns = fps_num ? (uint64_t)fps_den * 1000000000ULL / fps_num : 0;
+		origin_ns = interval_ns ? origin % interval_ns : 0;
+	}
+
+	bool valid() const { return interval_ns > 0; }
+
+	uint64_t at_or_before(uint64_t ts) const {
+		if (ts < origin_ns) return 0;
+		return origin_ns + ((ts - origin_ns) / interval_ns) * interval_ns;
+	}
+
+	uint64_t at_or_after(uint64_t ts) const {
+		uint64_t before = at_or_before(ts);
+		return before == ts ? ts : before + interval_ns;
+	}
+};
@@ -0,0 +1,196 @@
+#include "mpv-worker-pool.hpp"
+#include "mpv-trace.hpp"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+thread_local int t_worker_index = -1;
+
+void lower_thread_priority() {
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__APPLE__)
+	pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10); // Niceness is per thread on Linux
+#endif
+}
+
+} // namespace
+
+MpvTaskGroup::MpvTaskGroup() : m_state(std::make_shared<State>()) {
+	MpvWorkerPool::instance(); // So it outlives static groups (and their owners)
+}
+
+MpvTaskGroup::~MpvTaskGroup() {
+	cancel();
+	wait();
+}
+
+void MpvTaskGroup::cancel() {
+	m_state->cancelled = true;
+	MpvWorkerPool::instance().purge(m_state.get());
+}
+
+void MpvTaskGroup::wait() {
+	// Must not be called from one of the group's own tasks
+	std::unique_lock<std::mutex> lock(m_state->mutex);
+	m_state->done.wait(lock, [this] { return m_state->pending == 0; });
+}
+
+MpvWorkerPool::~MpvWorkerPool() { shutdown(); }
+
+MpvWorkerPool &MpvWorkerPool::instance() {
+	static MpvWorkerPool pool;
+	return pool;
+}
+
+void MpvWorkerPool::submit(MpvTaskGroup &group, MpvTaskPriority priority, std::function<void()> fn) {
+	if (group.cancelled()) return;
+	{
+		// Held across the push so shutdown cannot miss the task, and so a
+		// worker cannot sleep between its empty-queue check and the wait
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_stopping) return;
+		if (m_workers.empty()) start_locked();
+
+		size_t target = t_worker_index >= 0 ? (size_t)t_worker_index : m_next++ % m_workers.size();
+		group.m_state->pending++;
+		Worker &w = *m_workers[target];
+		std::lock_guard<std::mutex> worker_lock(w.mutex);
+		w.queues[(int)priority].push_back({group.m_state, std::move(fn)});
+		m_queued++;
+	}
+	m_wake.notify_one();
+}
+
+void MpvWorkerPool::start_locked() {
+	// Probes and decodes run mpv's own demuxer/decoder threads underneath, so
+	// a few workers keep the cores busy without crowding playback.
+	int count = std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 4);
+	for (int i = 0; i < count; i++) m_workers.push_back(std::make_unique<Worker>());
+	for (int i = 0; i < count; i++) m_workers[i]->thread = std::thread(&MpvWorkerPool::worker_func, this, (size_t)i);
+	obs_log(LOG_INFO, "Started %d background worker threads", count);
+}
+
+void MpvWorkerPool::worker_func(size_t index) {
+	t_worker_index = (int)index;
+	lower_thread_priority();
+	mpv_trace_thread_name("mpv worker");
+
+	while (!m_stopping) {
+		Task task;
+		if (take(index, task)) {
+			if (!task.group->cancelled) {
+				MPV_TRACE_SCOPE("worker_task");
+				task.fn();
+			}
+			finish(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this] { return m_stopping || m_queued > 0; });
+		if (m_stopping) break;
+	}
+}
+
+bool MpvWorkerPool::take(size_t index, Task &task) {
+	size_t n = m_workers.size();
+	for (int p = 0; p < kMpvTaskPriorities; p++) {
+		{
+			Worker &own = *m_workers[index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			auto &queue = own.queues[p];
+			if (!queue.empty()) {
+				task = std::move(queue.front());
+				queue.pop_front();
+				m_queued--;
+				return true;
+			}
+		}
+		for (size_t i = 1; i < n; i++) {
+			Worker &other = *m_workers[(index + i) % n];
+			std::lock_guard<std::mutex> lock(other.mutex);
+			auto &queue = other.queues[p];
+			if (!queue.empty()) {
+				task = std::move(queue.back());
+				queue.pop_back();
+				m_queued--;
+				m_stolen++;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void MpvWorkerPool::finish(Task &task) {
+	task.fn = nullptr; // Drop captures before the owner may go away
+	m_completed++;
+	std::lock_guard<std::mutex> lock(task.group->mutex);
+	task.group->pending--;
+	task.group->done.notify_all();
+}
+
+void MpvWorkerPool::purge(const MpvTaskGroup::State *group) {
+	std::vector<Task> dropped;
+	{
+		std::lock_guard<std::mutex> pool_lock(m_mutex);
+		for (auto &w : m_workers) {
+			std::lock_guard<std::mutex> lock(w->mutex);
+			for (auto &queue : w->queues) {
+				for (auto it = queue.begin(); it != queue.end();) {
+					if (group && it->group.get() != group) {
+						++it;
+						continue;
+					}
+					dropped.push_back(std::move(*it));
+					it = queue.erase(it);
+					m_queued--;
+				}
+			}
+		}
+	}
+	for (auto &task : dropped) finish(task);
+}
+
+void MpvWorkerPool::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_stopping) return;
+		m_stopping = true;
+	}
+	// Drop the backlog before joining, so only tasks already running finish
+	purge(nullptr);
+	m_wake.notify_all();
+	for (auto &w : m_workers)
+		if (w->thread.joinable()) w->thread.join();
+}
+
+MpvWorkerPool::Stats MpvWorkerPool::stats() {
+	std::lock_guard<std::mutex> pool_lock(m_mutex);
+	Stats st;
+	st.workers = (int)m_workers.size();
+	for (auto &w : m_workers) {
+		std::lock_guard<std::mutex> lock(w->mutex);
+		for (int p = 0; p < kMpvTaskPriorities; p++) st.queued[p] += (int)w->queues[p].size();
+	}
+	st.completed = m_completed;
+	st.stolen = m_stolen;
+	return st;
+}
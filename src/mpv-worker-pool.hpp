@@ -0,0 +1,187 @@
+#pragma once
+
+// Plugin-wide pool for background work (probing, clip preloads, analysis),
+// so the number of helper threads follows the core count instead of the
+// number of sources. Playback threads (render, audio) stay dedicated.
+//
+// Each worker owns a deque per priority class. Tasks submitted from a worker
+// go to its own deque, others are spread round-robin; a worker takes from
+// the front of its own deque (oldest first, so playlists are probed top to
+// bottom) and, when that is empty, steals from the back of the others'.
+// A worker always looks for higher-priority work anywhere before running its
+// own lower-priority tasks. Workers run at reduced OS priority so they do not
+// compete with playback.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class MpvTaskPriority {
+	Interactive, // The user is waiting on it (files just added)
+	Prefetch,    // Needed soon (clip preloads)
+	Background,  // Whenever there is time (probing a restored playlist)
+};
+constexpr int kMpvTaskPriorities = 3;
+
+// Tasks are submitted through a group owned by the submitter. Cancelling
+// drops its queued tasks; running ones can poll cancelled() to stop early.
+// The destructor cancels and waits, so a task never outlives its owner.
+// Creating a group creates the pool, so a static owner is destroyed first.
+class MpvTaskGroup {
+public:
+	MpvTaskGroup();
+	~MpvTaskGroup();
+	MpvTaskGroup(const MpvTaskGroup &) = delete;
+	MpvTaskGroup &operator=(const MpvTaskGroup &) = delete;
+
+	void cancel();
+	bool cancelled() const { return m_state->cancelled; }
+	void wait(); // Until none of the group's tasks is queued or running
+	int pending() const { return m_state->pending; }
+
+private:
+	friend class MpvWorkerPool;
+	struct State {
+		std::atomic<bool> cancelled{false};
+		std::atomic<int> pending{0};
+		std::mutex mutex;
+		std::condition_variable done;
+	};
+	std::shared_ptr<State> m_state;
+};
+
+class MpvWorkerPool {
+public:
+	static MpvWorkerPool &instance();
+	~MpvWorkerPool();
+
+	// Workers start on the first submit. Tasks of a cancelled group, or
+	// submitted after shutdown, are dropped.
+	void submit(MpvTaskGroup &group, MpvTaskPriority priority, std::function<void()> fn);
+
+	// Drops all queued tasks, waits for the running ones and joins the
+	// workers (module unload).
+	void shutdown();
+
+	struct Stats {
+		int workers = 0;
+		int queued[kMpvTaskPriorities] = {};
+		uint64_t completed = 0;
+		uint64_t stolen = 0; // Tasks run by a worker other than the one they were queued on
+	};
+	Stats stats();
+	bool idle() const { return m_queued == 0; } // Nothing queued (tasks may still be running)
+
+private:
+	struct Task {
+		std::shared_ptr<MpvTaskGroup::State> group;
+		std::function<void()> fn;
+	};
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Task> queues[kMpvTaskPriorities];
+		std::thread thread;
+	};
+
+	std::mutex m_mutex; // Guards m_workers while starting/stopping, and sleeping workers
+	std::condition_variable m_wake;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::atomic<int> m_queued{0};
+	std::atomic<bool> m_stopping{false};
+	std::atomic<uint32_t> m_next{0};
+	std::atomic<uint64_t> m_completed{0};
+	std::atomic<uint64_t> m_stolen{0};
+
+	friend class MpvTaskGroup;
+	void start_locked();
+	void worker_func(size_t index);
+	bool take(size_t index, Task &task);
+	void finish(Task &task);
+	void purge(const MpvTaskGroup::State *group);
+};
+
+// Jobs run one at a time and in order, each as a pool task of its own, so
+// a background producer (thumbnails, seek indexes, loudness) never occupies
+// more than one worker. on_idle runs on the pool whenever the queue has run
+// dry, e.g. to close a decoder kept open between jobs.
+template <typename Job> class MpvSerialQueue {
+public:
+	MpvSerialQueue(MpvTaskPriority priority, std::function<void(Job &)> run, std::function<void()> on_idle = {})
+		: m_priority(priority), m_run(std::move(run)), m_on_idle(std::move(on_idle)) {}
+	~MpvSerialQueue() { shutdown(); }
+	MpvSerialQueue(const MpvSerialQueue &) = delete;
+	MpvSerialQueue &operator=(const MpvSerialQueue &) = delete;
+
+	void push(Job job) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(std::move(job));
+		if (!m_running && !m_tasks.cancelled()) {
+			m_running = true;
+			submit();
+		}
+	}
+
+	// Drops queued jobs (not the running one) for which pred is true
+	template <typename Pred> void remove_if(Pred pred) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), pred), m_jobs.end());
+	}
+
+	// Drops the queue and waits for the running job; nothing runs after this
+	// (module unload)
+	void shutdown() {
+		m_tasks.cancel();
+		m_tasks.wait();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.clear();
+		m_running = false;
+	}
+
+	// For jobs to poll, or to hand to whatever they wait on
+	const MpvTaskGroup &tasks() const { return m_tasks; }
+
+private:
+	MpvTaskPriority m_priority;
+	std::function<void(Job &)> m_run;
+	std::function<void()> m_on_idle;
+	std::mutex m_mutex;
+	std::deque<Job> m_jobs;
+	bool m_running = false;
+	MpvTaskGroup m_tasks;
+
+	void submit() {
+		MpvWorkerPool::instance().submit(m_tasks, m_priority, [this] { run_next(); });
+	}
+
+	void run_next() {
+		Job job;
+		bool have_job = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_jobs.empty() && !m_tasks.cancelled()) {
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+				have_job = true;
+			}
+		}
+		if (!have_job) {
+			if (m_on_idle) m_on_idle();
+			// A job pushed during on_idle found m_running still set
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_jobs.empty() || m_tasks.cancelled())
+				m_running = false;
+			else
+				submit();
+			return;
+		}
+		m_run(job);
+		submit(); // The next job, or the idle step
+	}
+};
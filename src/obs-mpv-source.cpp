@@ -1,11 +1,9 @@
 #include "obs-mpv-source.hpp"
+#include "mpv-audio.hpp"
+#include "mpv-trace.hpp"
+#include "mpv-video.hpp"
 #include <util/platform.h>
 #include <util/threading.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#ifndef _WIN32
-#include <unistd.h>
-#endif
 #include <cstdio>
 #include <cstdarg>
 #include <cmath>
@@ -14,16 +12,6 @@
 #include <cinttypes>
 #include <chrono>
 
-#ifdef _WIN32
-#define NOMINMAX
-#include <windows.h>
-#include <io.h>
-#else
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-#endif
-
 #define S_FILE_PATH "file_path"
 
 struct obs_source_info mpv_source_info = {
@@ -35,10 +23,13 @@ struct obs_source_info mpv_source_info = {
 	.destroy = ObsMpvSource::obs_destroy,
 	.get_width = ObsMpvSource::obs_get_width,
 	.get_height = ObsMpvSource::obs_get_height,
+	.get_defaults = ObsMpvSource::obs_get_defaults,
 	.get_properties = ObsMpvSource::obs_get_properties,
 	.update = ObsMpvSource::obs_properties_update,
 	.activate = ObsMpvSource::obs_activate,
 	.deactivate = ObsMpvSource::obs_deactivate,
+	.show = ObsMpvSource::obs_show,
+	.hide = ObsMpvSource::obs_hide,
 	.video_tick = ObsMpvSource::obs_video_tick,
 	.save = ObsMpvSource::obs_save,
 	.media_play_pause = ObsMpvSource::obs_media_play_pause,
@@ -56,13 +47,132 @@ void *ObsMpvSource::obs_create(obs_data_t *settings, obs_source_t *source) {
 
 void ObsMpvSource::obs_destroy(void *data) { delete static_cast<ObsMpvSource *>(data); }
 
+static const char *const k_decoder_defaults_file = "decoder-defaults.json";
+
+void ObsMpvSource::obs_get_defaults(obs_data_t *settings) {
+	obs_data_set_default_string(settings, "hwdec", "auto");
+	obs_data_set_default_int(settings, "resample_quality", 1); // mpv's default
+	obs_data_set_default_int(settings, "seek_mode", SEEK_MODE_EXACT); // What plain time-pos seeks always did
+	obs_data_set_default_int(settings, "frame_queue_mb", 128);
+	obs_data_set_default_double(settings, "image_duration", 5.0);
+	obs_data_set_default_int(settings, "image_cache_mb", 256);
+	obs_data_set_default_int(settings, "clip_cache_mb", 256);
+	obs_data_set_default_int(settings, "decoder_threads", 0);
+	obs_data_set_default_int(settings, "demuxer_max_mb", 150);
+	obs_data_set_default_double(settings, "demuxer_readahead", 1.0);
+	obs_data_set_default_string(settings, "framedrop", "vo");
+	obs_data_set_default_int(settings, "idle_release", 0);
+	obs_data_set_default_bool(settings, "auto_gain", false);
+	obs_data_set_default_double(settings, "target_lufs", -23.0);
+	obs_data_set_default_int(settings, "frame_history_mb", 0); // Copies every frame, so opt-in
+
+	// Plugin-wide defaults saved with "Use as default for new sources"
+	char *path = obs_module_config_path(k_decoder_defaults_file);
+	obs_data_t *saved = path ? obs_data_create_from_json_file_safe(path, "bak") : nullptr;
+	bfree(path);
+	if (!saved) return;
+	if (obs_data_has_user_value(saved, "hwdec"))
+		obs_data_set_default_string(settings, "hwdec", obs_data_get_string(saved, "hwdec"));
+	if (obs_data_has_user_value(saved, "decoder_threads"))
+		obs_data_set_default_int(settings, "decoder_threads", obs_data_get_int(saved, "decoder_threads"));
+	if (obs_data_has_user_value(saved, "demuxer_max_mb"))
+		obs_data_set_default_int(settings, "demuxer_max_mb", obs_data_get_int(saved, "demuxer_max_mb"));
+	if (obs_data_has_user_value(saved, "demuxer_readahead"))
+		obs_data_set_default_double(settings, "demuxer_readahead", obs_data_get_double(saved, "demuxer_readahead"));
+	if (obs_data_has_user_value(saved, "framedrop"))
+		obs_data_set_default_string(settings, "framedrop", obs_data_get_string(saved, "framedrop"));
+	obs_data_release(saved);
+}
+
 obs_properties_t *ObsMpvSource::obs_get_properties(void *) {
 	obs_properties_t *props = obs_properties_create();
+	obs_properties_add_bool(props, "audio_planar", obs_module_text("AudioPlanar"));
+	obs_properties_add_bool(props, "audio_match_obs", obs_module_text("AudioMatchObs"));
+	obs_property_t *hidden = obs_properties_add_list(props, "hidden_video", obs_module_text("HiddenVideo"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(hidden, obs_module_text("HiddenVideo.Render"), HIDDEN_VIDEO_RENDER);
+	obs_property_list_add_int(hidden, obs_module_text("HiddenVideo.SkipRender"), HIDDEN_VIDEO_SKIP_RENDER);
+	obs_property_list_add_int(hidden, obs_module_text("HiddenVideo.DisableTrack"), HIDDEN_VIDEO_DISABLE_TRACK);
+	obs_property_t *quality = obs_properties_add_list(props, "resample_quality", obs_module_text("ResampleQuality"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(quality, obs_module_text("ResampleQuality.Fast"), 0);
+	obs_property_list_add_int(quality, obs_module_text("ResampleQuality.Default"), 1);
+	obs_property_list_add_int(quality, obs_module_text("ResampleQuality.High"), 2);
+	obs_property_t *fps_mode = obs_properties_add_list(props, "fps_mode", obs_module_text("FpsMode"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(fps_mode, obs_module_text("FpsMode.Off"), FPS_MODE_OFF);
+	obs_property_list_add_int(fps_mode, obs_module_text("FpsMode.ResetObs"), FPS_MODE_RESET_OBS);
+	obs_property_list_add_int(fps_mode, obs_module_text("FpsMode.Conform"), FPS_MODE_CONFORM);
+	obs_property_list_add_int(fps_mode, obs_module_text("FpsMode.ConformBlend"), FPS_MODE_CONFORM_BLEND);
+	obs_property_t *seek_mode = obs_properties_add_list(props, "seek_mode", obs_module_text("SeekMode"),
+							    OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(seek_mode, obs_module_text("SeekMode.Exact"), SEEK_MODE_EXACT);
+	obs_property_list_add_int(seek_mode, obs_module_text("SeekMode.Fast"), SEEK_MODE_FAST);
+	obs_property_t *render_size = obs_properties_add_list(props, "render_size", obs_module_text("RenderSize"),
+							      OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(render_size, obs_module_text("RenderSize.Native"), RENDER_SIZE_NATIVE);
+	obs_property_list_add_int(render_size, obs_module_text("RenderSize.Fixed"), RENDER_SIZE_FIXED);
+	obs_property_list_add_int(render_size, obs_module_text("RenderSize.MatchBounds"), RENDER_SIZE_MATCH_BOUNDS);
+	obs_property_set_long_description(render_size, obs_module_text("RenderSize.Description"));
+	obs_properties_add_int(props, "render_width", obs_module_text("RenderWidth"), 16, 8192, 2);
+	obs_properties_add_int(props, "render_height", obs_module_text("RenderHeight"), 16, 8192, 2);
+	obs_property_t *queue = obs_properties_add_int_slider(props, "frame_queue", obs_module_text("FrameQueue"), 0, 16, 1);
+	obs_property_set_long_description(queue, obs_module_text("FrameQueue.Description"));
+	obs_property_t *queue_mb = obs_properties_add_int(props, "frame_queue_mb", obs_module_text("FrameQueueMemory"), 16, 2048, 16);
+	obs_property_int_set_suffix(queue_mb, " MB");
+	obs_property_t *image_duration =
+		obs_properties_add_float(props, "image_duration", obs_module_text("ImageDuration"), 0.5, 3600.0, 0.5);
+	obs_property_float_set_suffix(image_duration, " s");
+	obs_property_t *image_cache =
+		obs_properties_add_int(props, "image_cache_mb", obs_module_text("ImageCacheMemory"), 16, 4096, 16);
+	obs_property_int_set_suffix(image_cache, " MB");
+	obs_property_t *clip_cache =
+		obs_properties_add_int(props, "clip_cache_mb", obs_module_text("ClipCacheMemory"), 16, 4096, 16);
+	obs_property_int_set_suffix(clip_cache, " MB");
+	obs_property_set_long_description(clip_cache, obs_module_text("ClipCacheMemory.Description"));
+	obs_property_t *history =
+		obs_properties_add_int(props, "frame_history_mb", obs_module_text("FrameHistoryMemory"), 0, 2048, 16);
+	obs_property_int_set_suffix(history, " MB");
+	obs_property_set_long_description(history, obs_module_text("FrameHistoryMemory.Description"));
+
+	// The render context is software, so hardware decoding always copies frames back
+	obs_property_t *hwdec = obs_properties_add_list(props, "hwdec", obs_module_text("Hwdec"), OBS_COMBO_TYPE_LIST,
+							OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(hwdec, obs_module_text("Hwdec.Auto"), "auto");
+	obs_property_list_add_string(hwdec, obs_module_text("Hwdec.AutoCopy"), "auto-copy");
+	obs_property_list_add_string(hwdec, obs_module_text("Hwdec.Software"), "no");
+	obs_property_list_add_string(hwdec, "NVDEC (copy-back)", "nvdec-copy");
+	obs_property_list_add_string(hwdec, "VA-API (copy-back)", "vaapi-copy");
+	obs_property_list_add_string(hwdec, "D3D11VA (copy-back)", "d3d11va-copy");
+	obs_property_list_add_string(hwdec, "VideoToolbox (copy-back)", "videotoolbox-copy");
+	obs_property_set_long_description(hwdec, obs_module_text("Hwdec.Description"));
+	obs_properties_add_int(props, "decoder_threads", obs_module_text("DecoderThreads"), 0, 64, 1);
+	obs_property_t *demux_mb =
+		obs_properties_add_int(props, "demuxer_max_mb", obs_module_text("DemuxerMaxMemory"), 8, 2048, 8);
+	obs_property_int_set_suffix(demux_mb, " MB");
+	obs_property_t *readahead =
+		obs_properties_add_float(props, "demuxer_readahead", obs_module_text("DemuxerReadahead"), 0.0, 60.0, 0.5);
+	obs_property_float_set_suffix(readahead, " s");
+	obs_property_t *framedrop = obs_properties_add_list(props, "framedrop", obs_module_text("Framedrop"),
+							    OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(framedrop, obs_module_text("Framedrop.Vo"), "vo");
+	obs_property_list_add_string(framedrop, obs_module_text("Framedrop.Decoder"), "decoder+vo");
+	obs_property_list_add_string(framedrop, obs_module_text("Framedrop.No"), "no");
+	obs_properties_add_button(props, "decoder_save_defaults", obs_module_text("DecoderSaveDefaults"),
+				  save_decoder_defaults);
+	obs_property_t *idle_release =
+		obs_properties_add_int(props, "idle_release", obs_module_text("IdleRelease"), 0, 86400, 10);
+	obs_property_int_set_suffix(idle_release, " s");
+	obs_property_set_long_description(idle_release, obs_module_text("IdleRelease.Description"));
+	obs_property_t *auto_gain = obs_properties_add_bool(props, "auto_gain", obs_module_text("AutoGain"));
+	obs_property_set_long_description(auto_gain, obs_module_text("AutoGain.Description"));
+	obs_property_t *target_lufs =
+		obs_properties_add_float(props, "target_lufs", obs_module_text("TargetLoudness"), -40.0, -5.0, 0.5);
+	obs_property_float_set_suffix(target_lufs, " LUFS");
 	return props;
 }
 
 void ObsMpvSource::obs_activate(void *data) {
     auto self = static_cast<ObsMpvSource*>(data);
+    MpvLock lock(self->m_mpv_mutex);
+    self->m_active = true;
     if (self->m_restart_on_activate) {
         // Restart from beginning (first playlist item or beginning of current file)
         // If playlist has multiple items, usually restart means go to index 0?
@@ -89,121 +199,629 @@ void ObsMpvSource::obs_activate(void *data) {
 
 void ObsMpvSource::obs_deactivate(void *data) {
     auto self = static_cast<ObsMpvSource*>(data);
+    MpvLock lock(self->m_mpv_mutex);
+    self->m_active = false;
     if (self->m_pause_on_deactivate) {
         self->pause();
     }
 }
 
+void ObsMpvSource::obs_show(void *data) {
+    auto self = static_cast<ObsMpvSource*>(data);
+    MpvLock lock(self->m_mpv_mutex);
+    self->m_showing = true;
+    if (self->ensure_mpv() && !self->m_active) self->resume_released(true); // Back on preview: paused, as it was
+    self->update_video_track();
+    self->m_redraw_needed = true; // Resume with a fresh frame
+    self->m_last_output_hash = 0;
+}
+
+void ObsMpvSource::obs_hide(void *data) {
+    auto self = static_cast<ObsMpvSource*>(data);
+    MpvLock lock(self->m_mpv_mutex);
+    self->m_showing = false;
+    self->update_video_track();
+}
+
+void ObsMpvSource::update_video_track() {
+    // Only the video track is toggled; audio keeps playing either way.
+    if (!m_mpv) return; // Applied when mpv is created
+    bool disable = m_hidden_video_mode == HIDDEN_VIDEO_DISABLE_TRACK && !m_showing;
+    if (disable == m_video_track_disabled) return;
+    m_video_track_disabled = disable;
+    m_commands.set("vid", disable ? "no" : "auto");
+}
+
 void ObsMpvSource::obs_properties_update(void *data, obs_data_t *settings) {
     auto self = static_cast<ObsMpvSource*>(data);
+    MpvLock lock(self->m_mpv_mutex);
+    self->m_idle_release_ns = (uint64_t)std::max<long long>(obs_data_get_int(settings, "idle_release"), 0) * 1000000000ULL;
     self->m_restart_on_activate = obs_data_get_bool(settings, "restart_on_activate");
+    self->m_audio_planar = obs_data_get_bool(settings, "audio_planar");
+    self->m_audio_match_obs = obs_data_get_bool(settings, "audio_match_obs");
+    self->m_resample_quality = (int)obs_data_get_int(settings, "resample_quality");
+    self->apply_audio_output_format();
+    self->m_hidden_video_mode = (int)obs_data_get_int(settings, "hidden_video");
+    self->update_video_track();
+    self->set_fps_mode(fps_mode_setting(settings));
+    self->set_seek_mode((int)obs_data_get_int(settings, "seek_mode"));
+    self->update_frame_queue((int)obs_data_get_int(settings, "frame_queue"), (int)obs_data_get_int(settings, "frame_queue_mb"));
+    self->update_render_size(settings);
+    self->update_image_settings(settings);
+    self->m_clip_cache.set_limit_mb((int)obs_data_get_int(settings, "clip_cache_mb"));
+    self->set_history_limit((int)obs_data_get_int(settings, "frame_history_mb"));
+    self->apply_decoder_settings(settings);
     // self->m_pause_on_deactivate = obs_data_get_bool(settings, "pause_on_deactivate"); // Not exposed yet, hardcoded true for now or add to dock
     self->load_playlist(settings);
+    self->apply_loudness_settings(settings);
 }
 
-void ObsMpvSource::on_mpv_render_update(void *ctx) { static_cast<ObsMpvSource*>(ctx)->m_redraw_needed = true; }
+void ObsMpvSource::on_mpv_render_update(void *ctx) {
+	// The tick (or worker) asks mpv_render_context_update() what changed;
+	// this only needs to wake the worker.
+	auto self = static_cast<ObsMpvSource*>(ctx);
+	if (self->m_render_worker_active) {
+		{
+			std::lock_guard<std::mutex> lock(self->m_frame_queue_mutex);
+			self->m_render_pending = true;
+		}
+		self->m_frame_queue_cv.notify_one();
+	}
+}
 void ObsMpvSource::on_mpv_wakeup(void *ctx) { static_cast<ObsMpvSource*>(ctx)->m_events_available = true; }
 void ObsMpvSource::on_mpv_audio_playback(void *, void *, int) {
 	// Unused in FIFO implementation
 }
 
-void ObsMpvSource::obs_video_tick(void *data, float) {
+void ObsMpvSource::obs_video_tick(void *data, float seconds) {
 	auto self = static_cast<ObsMpvSource *>(data);
+	mpv_trace_thread_name("obs video tick");
+	MPV_TRACE_SCOPE("video_tick");
+	{
+		MpvLock mpv_lock(self->m_mpv_mutex);
+		if (!self->tick_control(seconds)) return;
+	}
+	self->tick_render();
+}
 
-	if (self->m_events_available) {
-		self->m_events_available = false;
-		self->handle_mpv_events();
+bool ObsMpvSource::tick_control(float seconds) {
+	// Everything on the tick but the render; false when there is nothing
+	// left to render directly
+	if (m_events_available) {
+		m_events_available = false;
+		handle_mpv_events();
 	}
 
-	if (self->m_mpv_render_ctx) {
-		if (mpv_render_context_update(self->m_mpv_render_ctx) & MPV_RENDER_UPDATE_FRAME || self->m_redraw_needed) {
-			self->m_redraw_needed = false;
+	if (m_probe_results_ready) apply_probe_results();
+	if (m_auto_gain && MpvLoudnessAnalyzer::instance().revision() != m_loudness_revision)
+		apply_loudness_results();
+	if (m_image_active) tick_image();
+	check_idle();
+	if (!m_mpv_render_ctx) return false;
+	check_history_reset();
+	if (m_shuttle < 0) tick_shuttle(seconds);
+
+	if (m_render_size_mode == RENDER_SIZE_MATCH_BOUNDS) {
+		uint64_t now = os_gettime_ns();
+		if (now >= m_next_box_check_ns) {
+			m_next_box_check_ns = now + 1000000000ULL; // Scene layouts change rarely
+			update_render_box();
+		}
+	}
 
-			// Check dimensions before rendering to prevent flashing
-			int64_t w = 0, h = 0;
-			mpv_get_property(self->m_mpv, "width", MPV_FORMAT_INT64, &w);
-			mpv_get_property(self->m_mpv, "height", MPV_FORMAT_INT64, &h);
+	if (m_render_worker_active) {
+		drain_frame_queue(seconds);
+		return false;
+	}
+	return true;
+}
 
-			if (w <= 0 || h <= 0) return;
-			if ((uint32_t)w != self->m_width || (uint32_t)h != self->m_height) {
-				self->m_width = (uint32_t)w;
-				self->m_height = (uint32_t)h;
-				return; // Wait for next tick with correct size
-			}
+void ObsMpvSource::tick_render() {
+	// A direct render blocks until the frame's display time and takes long
+	// for big frames, so like the render worker it only holds m_render_mutex:
+	// the controls and the dock's getters don't wait for it. mpv outlives the
+	// render context, which destroy_mpv() frees under that mutex.
+	bool new_frame;
+	bool conform;
+	uint64_t display_ts;
+	uint32_t width, height;
+	double time = 0.0;
+	{
+		std::lock_guard<std::mutex> render_lock(m_render_mutex);
+		if (!m_mpv_render_ctx || m_render_worker_active) return; // Released or changed since the tick checked
+		if (m_hidden_video_mode != HIDDEN_VIDEO_RENDER && !m_showing) {
+			// Not on any visible scene: keep mpv's frame queue moving with a tiny
+			// render that is never output, so audio carries on without stalling.
+			if (mpv_render_context_update(m_mpv_render_ctx) & MPV_RENDER_UPDATE_FRAME) render_discard();
+			return;
+		}
 
-			size_t stride = self->m_width * 4;
-			self->m_sw_buffer.resize(stride * self->m_height);
-
-			int size[] = {(int)self->m_width, (int)self->m_height};
-			mpv_render_param p[] = {{MPV_RENDER_PARAM_SW_SIZE, size}, {MPV_RENDER_PARAM_SW_FORMAT, (void*)"bgra"}, {MPV_RENDER_PARAM_SW_STRIDE, &stride}, {MPV_RENDER_PARAM_SW_POINTER, self->m_sw_buffer.data()}, {MPV_RENDER_PARAM_INVALID, nullptr}};
-
-			if (mpv_render_context_render(self->m_mpv_render_ctx, p) >= 0) {
-				struct obs_source_frame frame = {};
-				frame.data[0] = self->m_sw_buffer.data();
-				frame.linesize[0] = (uint32_t)stride;
-				frame.width = self->m_width;
-				frame.height = self->m_height;
-				frame.format = VIDEO_FORMAT_BGRA;
-				frame.timestamp = os_gettime_ns();
-
-				if (!self->m_av_sync_started) {
-					self->m_av_sync_started = true;
-					self->m_audio_start_ts = frame.timestamp;
-					self->m_total_audio_frames = 0;
-					blog(LOG_INFO, "A/V sync started. First video frame TS: %" PRIu64, (uint64_t)self->m_audio_start_ts);
-				}
+		new_frame = mpv_render_context_update(m_mpv_render_ctx) & MPV_RENDER_UPDATE_FRAME;
+		if (new_frame && !m_redraw_needed && skip_repeated_frame()) return;
+		if (!new_frame && !m_redraw_needed) return;
+		m_redraw_needed = false;
+
+		// Check dimensions before rendering to prevent flashing
+		if (!refresh_video_size()) return;
+
+		// Conforming needs the frame early with its display time, so don't block for it
+		conform = m_fps_mode >= FPS_MODE_CONFORM;
+		display_ts = conform ? next_frame_display_time(nullptr) : 0;
+
+		width = m_width;
+		height = m_height;
+		m_sw_buffer.resize((size_t)width * 4 * height);
+		if (!render_sw(m_sw_buffer.data(), new_frame, !conform)) return;
+		// render_sw() waited for the frame's display time, so mpv is on it now
+		if (new_frame && m_history_enabled) mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &time);
+		if (!conform) display_ts = os_gettime_ns();
+	}
 
-				obs_source_output_video(self->m_source, &frame);
-			}
+	// The history and the conform state belong to the controls' side
+	MpvLock mpv_lock(m_mpv_mutex);
+	if (!m_mpv_render_ctx || m_sw_buffer.size() != (size_t)width * 4 * height) return; // Released meanwhile
+	if (new_frame && m_history_enabled && !record_history_frame(m_sw_buffer.data(), width, height, time)) return;
+	output_conformed_frame(m_sw_buffer.data(), width, height, display_ts);
+}
+
+bool ObsMpvSource::refresh_video_size() {
+	int64_t w = 0, h = 0;
+	mpv_get_property(m_mpv, "width", MPV_FORMAT_INT64, &w);
+	mpv_get_property(m_mpv, "height", MPV_FORMAT_INT64, &h);
+
+	if (w <= 0 || h <= 0) return false;
+	m_native_width = (uint32_t)w;
+	m_native_height = (uint32_t)h;
+
+	uint32_t out_w, out_h;
+	fit_render_size((uint32_t)w, (uint32_t)h, out_w, out_h);
+	if (out_w != m_width || out_h != m_height) {
+		m_width = out_w;
+		m_height = out_h;
+		m_redraw_needed = true;
+		return false; // Wait for the next frame with the correct size
+	}
+	return true;
+}
+
+void ObsMpvSource::fit_render_size(uint32_t native_w, uint32_t native_h, uint32_t &out_w, uint32_t &out_h) {
+	// Scale down (never up) to fit the target box, keeping the aspect ratio;
+	// mpv's software scaler does the work during the render.
+	out_w = native_w;
+	out_h = native_h;
+	uint32_t box_w = m_render_box_width, box_h = m_render_box_height;
+	if (m_render_size_mode == RENDER_SIZE_NATIVE || !box_w || !box_h) return;
+	if (native_w <= box_w && native_h <= box_h) return;
+
+	double scale = std::min((double)box_w / native_w, (double)box_h / native_h);
+	out_w = std::max<uint32_t>(2, (uint32_t)std::lround(native_w * scale) & ~1u);
+	out_h = std::max<uint32_t>(2, (uint32_t)std::lround(native_h * scale) & ~1u);
+}
+
+struct SceneItemBounds {
+	obs_source_t *source;
+	float width = 0.0f;
+	float height = 0.0f;
+	bool found = false;
+	bool unbounded = false;
+};
+
+static bool find_item_bounds(obs_scene_t *, obs_sceneitem_t *item, void *param) {
+	auto search = static_cast<SceneItemBounds *>(param);
+	if (obs_sceneitem_is_group(item)) obs_sceneitem_group_enum_items(item, find_item_bounds, param);
+	if (obs_sceneitem_get_source(item) != search->source) return true;
+
+	search->found = true;
+	if (obs_sceneitem_get_bounds_type(item) == OBS_BOUNDS_NONE) {
+		search->unbounded = true; // Its on-canvas size follows the source size
+		return true;
+	}
+	struct vec2 bounds;
+	obs_sceneitem_get_bounds(item, &bounds);
+	search->width = std::max(search->width, bounds.x);
+	search->height = std::max(search->height, bounds.y);
+	return true;
+}
+
+void ObsMpvSource::update_render_box() {
+	if (m_render_size_mode != RENDER_SIZE_MATCH_BOUNDS) return;
+
+	SceneItemBounds search;
+	search.source = m_source;
+	obs_enum_scenes(
+		[](void *param, obs_source_t *scene_source) {
+			obs_scene_t *scene = obs_scene_from_source(scene_source);
+			if (scene) obs_scene_enum_items(scene, find_item_bounds, param);
+			return true;
+		},
+		&search);
+
+	// Items without a bounding box would shrink along with the source, so any
+	// such item (or none at all) keeps native size.
+	uint32_t box_w = 0, box_h = 0;
+	if (search.found && !search.unbounded) {
+		box_w = (uint32_t)std::ceil(search.width);
+		box_h = (uint32_t)std::ceil(search.height);
+	}
+	if (box_w != m_render_box_width || box_h != m_render_box_height) {
+		m_render_box_width = box_w;
+		m_render_box_height = box_h;
+		m_redraw_needed = true;
+	}
+}
+
+void ObsMpvSource::update_render_size(obs_data_t *settings) {
+	m_render_size_mode = (int)obs_data_get_int(settings, "render_size");
+	if (m_render_size_mode == RENDER_SIZE_FIXED) {
+		m_render_box_width = obs_data_has_user_value(settings, "render_width")
+					     ? (uint32_t)obs_data_get_int(settings, "render_width")
+					     : 1280;
+		m_render_box_height = obs_data_has_user_value(settings, "render_height")
+					      ? (uint32_t)obs_data_get_int(settings, "render_height")
+					      : 720;
+	} else {
+		m_render_box_width = 0;
+		m_render_box_height = 0;
+		m_next_box_check_ns = 0; // Match mode: look at the scenes on the next tick
+	}
+	m_redraw_needed = true;
+}
+
+bool ObsMpvSource::render_sw(uint8_t *dst, bool new_frame, bool block) {
+	// Caller holds m_render_mutex
+	size_t stride = (size_t)m_width * 4;
+	int size[] = {(int)m_width, (int)m_height};
+	int block_for_target = block ? 1 : 0;
+	mpv_render_param p[] = {{MPV_RENDER_PARAM_SW_SIZE, size}, {MPV_RENDER_PARAM_SW_FORMAT, (void*)"bgra"}, {MPV_RENDER_PARAM_SW_STRIDE, &stride}, {MPV_RENDER_PARAM_SW_POINTER, dst}, {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target}, {MPV_RENDER_PARAM_INVALID, nullptr}};
+
+	uint64_t render_start = os_gettime_ns();
+	if (mpv_render_context_render(m_mpv_render_ctx, p) < 0) return false;
+	uint64_t render_end = os_gettime_ns();
+	m_stats.add_render(render_end - render_start, new_frame);
+	if (new_frame) note_seek_frame(render_end);
+	mpv_trace_span("render", render_start, render_end, new_frame);
+	return true;
+}
+
+void ObsMpvSource::render_discard() {
+	uint32_t pixels[16 * 16];
+	int size[] = {16, 16};
+	size_t stride = 16 * 4;
+	mpv_render_param p[] = {{MPV_RENDER_PARAM_SW_SIZE, size}, {MPV_RENDER_PARAM_SW_FORMAT, (void*)"bgra"}, {MPV_RENDER_PARAM_SW_STRIDE, &stride}, {MPV_RENDER_PARAM_SW_POINTER, pixels}, {MPV_RENDER_PARAM_INVALID, nullptr}};
+	mpv_render_context_render(m_mpv_render_ctx, p);
+}
+
+bool ObsMpvSource::skip_repeated_frame() {
+	// mpv redraws the current frame on pause, property changes etc. Once that
+	// frame has been output, consume the redraw with a tiny render instead.
+	if (m_last_output_hash == 0) return false;
+	mpv_render_frame_info info = {};
+	mpv_render_param info_param = {MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info};
+	if (mpv_render_context_get_info(m_mpv_render_ctx, info_param) < 0) return false;
+	if (!(info.flags & MPV_RENDER_FRAME_INFO_PRESENT)) return false;
+	if (!(info.flags & (MPV_RENDER_FRAME_INFO_REDRAW | MPV_RENDER_FRAME_INFO_REPEAT))) return false;
+
+	render_discard();
+	m_stats.frames_unchanged.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void ObsMpvSource::output_video_frame(uint8_t *data, uint32_t width, uint32_t height, uint64_t timestamp) {
+	// Audio waits for this, even if the frame itself is a duplicate below
+	if (!m_av_sync_started) start_av_sync(timestamp);
+
+	// Static slides and still images keep producing identical frames; OBS
+	// already shows the last one, so don't hand it over again.
+	uint64_t hash = mpv_video_hash(data, (size_t)width * 4, (size_t)width * 4, height, 4) ^ ((uint64_t)width << 32 | height);
+	if (hash == m_last_output_hash) {
+		m_stats.frames_unchanged.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	m_last_output_hash = hash;
+
+	struct obs_source_frame frame = {};
+	frame.data[0] = data;
+	frame.linesize[0] = width * 4;
+	frame.width = width;
+	frame.height = height;
+	frame.format = VIDEO_FORMAT_BGRA;
+	frame.timestamp = timestamp;
+
+	MPV_TRACE_SCOPE("output_video");
+	obs_source_output_video(m_source, &frame);
+}
+
+void ObsMpvSource::start_av_sync(uint64_t timestamp) {
+	// Anchors audio output: at the first video frame, or at the first audio
+	// when no frame is coming (see video_frames_expected). The video tick and
+	// the audio thread can both get here; only the first one anchors.
+	{
+		std::lock_guard<std::mutex> lock(m_audio_mutex);
+		bool expected = false;
+		if (!m_av_sync_started.compare_exchange_strong(expected, true)) return;
+		m_audio_start_ts = timestamp;
+		m_total_audio_frames = 0;
+	}
+	mpv_trace_instant("first_frame", m_current_index);
+	blog(LOG_INFO, "A/V sync started. First frame TS: %" PRIu64, timestamp);
+}
+
+bool ObsMpvSource::video_frames_expected() const {
+	// Hidden with a skip-render or disable-track mode, or no video at all,
+	// nothing reaches output_video_frame until that changes
+	return m_has_video && (m_showing || m_hidden_video_mode == HIDDEN_VIDEO_RENDER);
+}
+
+void ObsMpvSource::update_has_video() {
+	char *id = mpv_get_property_string(m_mpv, "current-tracks/video/id");
+	m_has_video = id != nullptr;
+	mpv_free(id);
+}
+
+uint64_t ObsMpvSource::next_frame_display_time(int64_t *lead_us) {
+	// mpv's target time for the frame about to be rendered, on the os_gettime_ns clock
+	uint64_t timestamp = os_gettime_ns();
+	int64_t lead = 0;
+	mpv_render_frame_info info = {};
+	mpv_render_param info_param = {MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info};
+	if (mpv_render_context_get_info(m_mpv_render_ctx, info_param) >= 0 && (info.flags & MPV_RENDER_FRAME_INFO_PRESENT) && info.target_time > 0) {
+		lead = info.target_time - mpv_get_time_us(m_mpv);
+		if (lead > 0) timestamp += (uint64_t)lead * 1000;
+	}
+	if (lead_us) *lead_us = lead;
+	return timestamp;
+}
+
+void ObsMpvSource::output_conformed_frame(uint8_t *data, uint32_t width, uint32_t height, uint64_t display_ts) {
+	if (m_image_capture) capture_image_frame(data, width, height);
+	int mode = m_fps_mode;
+	if (mode != FPS_MODE_CONFORM && mode != FPS_MODE_CONFORM_BLEND) {
+		output_video_frame(data, width, height, display_ts);
+		return;
+	}
+
+	obs_video_info ovi;
+	if (obs_get_video_info(&ovi) && ovi.fps_num > 0) {
+		uint64_t interval = (uint64_t)ovi.fps_den * 1000000000ULL / ovi.fps_num;
+		if (interval != m_canvas_clock.interval_ns) m_canvas_clock.reset(ovi.fps_num, ovi.fps_den, obs_get_video_frame_time());
+	}
+	if (!m_canvas_clock.valid()) {
+		output_video_frame(data, width, height, display_ts);
+		return;
+	}
+
+	// Pulldown: a frame starts on the first canvas frame at or after its display
+	// time, which gives the exact 2:3 / 3:2 cadence for film rates.
+	uint64_t ts = m_canvas_clock.at_or_after(display_ts);
+	size_t bytes = (size_t)width * 4 * height;
+
+	if (mode == FPS_MODE_CONFORM_BLEND && m_prev_frame_ts && m_prev_frame.size() == bytes) {
+		// The source frame boundary falls inside the canvas frame before ts (which
+		// still shows the previous frame): mix both by how much of it each covers.
+		uint64_t before = ts - m_canvas_clock.interval_ns;
+		if (display_ts > before && display_ts < ts && before > m_prev_frame_ts) {
+			int weight = (int)((ts - display_ts) * 256 / m_canvas_clock.interval_ns);
+			m_blend_buffer.resize(bytes);
+			mpv_video_blend(m_prev_frame.data(), data, m_blend_buffer.data(), bytes, weight);
+			output_video_frame(m_blend_buffer.data(), width, height, before);
 		}
 	}
+	output_video_frame(data, width, height, ts);
+
+	if (mode == FPS_MODE_CONFORM_BLEND) m_prev_frame.assign(data, data + bytes);
+	else m_prev_frame.clear();
+	m_prev_frame_ts = ts;
+}
+
+void ObsMpvSource::reset_conform() {
+	m_canvas_clock = {};
+	m_prev_frame_ts = 0;
+}
+
+void ObsMpvSource::update_frame_queue(int depth, int cap_mb) {
+	depth = std::clamp(depth, 0, 16);
+	cap_mb = std::max(cap_mb, 16);
+	{
+		std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+		m_frame_queue_depth = depth;
+		m_frame_queue_mb = cap_mb;
+	}
+	m_frame_queue_cv.notify_one();
+
+	if (depth > 0 && m_mpv && !m_render_thread.joinable()) {
+		m_stop_render_thread = false;
+		m_render_worker_active = true;
+		m_render_thread = std::thread(&ObsMpvSource::render_thread_func, this);
+	} else if (depth == 0 && m_render_thread.joinable()) {
+		stop_render_worker();
+	}
+	apply_video_timing();
+}
+
+void ObsMpvSource::stop_render_worker() {
+	if (!m_render_thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+		m_stop_render_thread = true;
+	}
+	m_frame_queue_cv.notify_one();
+	m_render_thread.join();
+	m_render_worker_active = false;
+
+	std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+	m_frame_queue.clear();
+	m_frame_pool.clear();
+	m_frame_queue_capacity = 0;
+	m_stats.frame_queue_depth.store(0, std::memory_order_relaxed);
+	m_redraw_needed = true; // Direct rendering picks up from here
+}
+
+void ObsMpvSource::apply_video_timing() {
+	// mpv hands a frame to the render API video-timing-offset seconds before
+	// its display time, so that offset is how far the worker can run ahead.
+	// vd-queue additionally decodes ahead on its own thread.
+	if (!m_mpv) return;
+	char buf[32];
+	double offset = 0.05; // mpv's default
+	if (m_frame_queue_depth > 0) {
+		double fps = 0.0;
+		mpv_get_property(m_mpv, "container-fps", MPV_FORMAT_DOUBLE, &fps);
+		if (fps <= 0.0) fps = 30.0;
+		offset = std::min(1.0, m_frame_queue_depth / fps);
+		m_frame_queue_lookahead_ns = (uint64_t)(offset * 1e9);
+
+		mpv_set_option_string(m_mpv, "vd-queue-enable", "yes");
+		snprintf(buf, sizeof(buf), "%d", m_frame_queue_depth);
+		mpv_set_option_string(m_mpv, "vd-queue-max-samples", buf);
+		snprintf(buf, sizeof(buf), "%dMiB", m_frame_queue_mb);
+		mpv_set_option_string(m_mpv, "vd-queue-max-bytes", buf);
+	} else {
+		m_frame_queue_lookahead_ns = 0;
+		mpv_set_option_string(m_mpv, "vd-queue-enable", "no");
+	}
+
+	// Conforming places (and blends) each frame one canvas frame before its
+	// display time, so it must arrive at least two canvas frames early.
+	obs_video_info ovi;
+	if (m_fps_mode >= FPS_MODE_CONFORM && obs_get_video_info(&ovi) && ovi.fps_num > 0)
+		offset = std::max(offset, std::min(1.0, 2.5 * ovi.fps_den / ovi.fps_num));
+
+	snprintf(buf, sizeof(buf), "%.3f", offset);
+	mpv_set_option_string(m_mpv, "video-timing-offset", buf);
+}
+
+void ObsMpvSource::flush_frame_queue() {
+	std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+	for (auto &f : m_frame_queue) m_frame_pool.push_back(std::move(f.data));
+	m_frame_queue.clear();
+	m_stats.frame_queue_depth.store(0, std::memory_order_relaxed);
+	m_frame_queue_cv.notify_one();
+}
+
+void ObsMpvSource::render_thread_func() {
+	mpv_trace_thread_name("mpv render");
+	std::unique_lock<std::mutex> lock(m_frame_queue_mutex);
+	while (!m_stop_render_thread) {
+		m_frame_queue_cv.wait(lock, [this] {
+			return m_stop_render_thread ||
+			       (m_render_pending && m_frame_queue.size() < std::max<size_t>(m_frame_queue_capacity, 1));
+		});
+		if (m_stop_render_thread) break;
+		m_render_pending = false;
+		lock.unlock();
+		render_queued_frame();
+		lock.lock();
+	}
 }
 
-ObsMpvSource::ObsMpvSource(obs_source_t *source, obs_data_t *settings) : m_source(source), m_width(0), m_height(0), m_events_available(false), m_redraw_needed(false), m_stop_audio_thread(false), m_flush_audio_buffer(false), m_av_sync_started(false), m_sample_rate(48000), m_channels(2), m_current_index(-1), m_is_loading(false), m_total_audio_frames(0), m_audio_start_ts(0) {
-	// Setup FIFO/Pipe for audio
-	char fifo_path[256];
-	#ifdef _WIN32
-	snprintf(fifo_path, sizeof(fifo_path), "\\\\.\\pipe\\obs_mpv_audio_%p", this);
-	m_fifo_path = fifo_path;
-	m_pipe_handle = CreateNamedPipeA(
-	m_fifo_path.c_str(),
-	PIPE_ACCESS_INBOUND,
-	PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
-	1,
-	4096 * 32,
-	4096 * 32,
-	0,
-	NULL
-	);
-	#else
-	snprintf(fifo_path, sizeof(fifo_path), "/tmp/obs_mpv_audio_%p", this);
-	m_fifo_path = fifo_path;
-	mkfifo(m_fifo_path.c_str(), 0666);
-	#endif
-
-	m_mpv = mpv_create();
-	mpv_request_log_messages(m_mpv, "info");
+void ObsMpvSource::render_queued_frame() {
+	std::lock_guard<std::mutex> render_lock(m_render_mutex);
+	bool new_frame = mpv_render_context_update(m_mpv_render_ctx) & MPV_RENDER_UPDATE_FRAME;
+	if (m_hidden_video_mode != HIDDEN_VIDEO_RENDER && !m_showing) {
+		if (new_frame) render_discard();
+		return;
+	}
+	if (!new_frame && !m_redraw_needed) return;
+	if (!m_redraw_needed && skip_repeated_frame()) return;
+	m_redraw_needed = false;
+
+	if (!refresh_video_size()) {
+		if (m_width > 0 && m_height > 0) {
+			// Size just changed; render this frame at the new size on the next pass
+			m_redraw_needed = true;
+			std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+			m_render_pending = true;
+		}
+		return;
+	}
+
+	// Stamp the frame with mpv's display target so the tick can release it on time
+	int64_t lead_us = 0;
+	uint64_t timestamp = next_frame_display_time(&lead_us);
+
+	size_t bytes = (size_t)m_width * 4 * m_height;
+	QueuedFrame frame;
+	{
+		std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+		size_t cap_frames = ((size_t)m_frame_queue_mb << 20) / bytes;
+		m_frame_queue_capacity = std::clamp<size_t>(cap_frames, 1, (size_t)std::max(m_frame_queue_depth, 1));
+		if (!m_frame_pool.empty()) {
+			frame.data = std::move(m_frame_pool.back());
+			m_frame_pool.pop_back();
+		}
+	}
+	frame.data.resize(bytes);
+	frame.width = m_width;
+	frame.height = m_height;
+	frame.timestamp = timestamp;
+	frame.new_frame = new_frame;
+
+	if (!render_sw(frame.data.data(), new_frame, false)) {
+		std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+		m_frame_pool.push_back(std::move(frame.data));
+		return;
+	}
+	// mpv moves time-pos to a frame when it hands it to the render context,
+	// so it is this frame's pts now; by the time the frame is released from
+	// the queue, mpv is up to the queue depth ahead
+	if (new_frame && m_history_enabled) mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &frame.time);
+
+	std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+	// A decode spike shows up as a frame handed over with less lead than the
+	// queue normally has. It was absorbed if it is still not late.
+	if (new_frame && m_frame_queue_lookahead_ns > 0 && lead_us * 1000 < (int64_t)m_frame_queue_lookahead_ns / 2 && !m_core_idle) {
+		m_stats.frame_spikes.fetch_add(1, std::memory_order_relaxed);
+		if (lead_us >= 0) m_stats.spikes_absorbed.fetch_add(1, std::memory_order_relaxed);
+	}
+	m_frame_queue.push_back(std::move(frame));
+	m_stats.frame_queue_depth.store(m_frame_queue.size(), std::memory_order_relaxed);
+}
 
+void ObsMpvSource::drain_frame_queue(float seconds) {
+	// Release every frame due by the middle of this tick; only the newest is shown.
+	// Conformed frames are due one canvas frame early, in case they get blended.
+	uint64_t due = os_gettime_ns() + (uint64_t)(seconds * 0.5e9);
+	if (m_fps_mode >= FPS_MODE_CONFORM && m_canvas_clock.valid()) due += m_canvas_clock.interval_ns;
+	QueuedFrame frame;
+	bool have_frame = false;
+	{
+		std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+		while (!m_frame_queue.empty() && m_frame_queue.front().timestamp <= due) {
+			if (have_frame) {
+				m_frame_pool.push_back(std::move(frame.data));
+				m_stats.frames_superseded.fetch_add(1, std::memory_order_relaxed);
+			}
+			frame = std::move(m_frame_queue.front());
+			m_frame_queue.pop_front();
+			have_frame = true;
+		}
+		m_stats.frame_queue_depth.store(m_frame_queue.size(), std::memory_order_relaxed);
+	}
+	if (!have_frame) return;
+	m_frame_queue_cv.notify_one();
+
+	if (!frame.new_frame || !m_history_enabled ||
+	    record_history_frame(frame.data.data(), frame.width, frame.height, frame.time))
+		output_conformed_frame(frame.data.data(), frame.width, frame.height, frame.timestamp);
+
+	std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+	// Keep at most one spare buffer beyond the queue capacity (memory cap)
+	if (m_frame_pool.size() + m_frame_queue.size() <= m_frame_queue_capacity) m_frame_pool.push_back(std::move(frame.data));
+}
+
+ObsMpvSource::ObsMpvSource(obs_source_t *source, obs_data_t *settings) : m_source(source), m_current_index(-1), m_width(0), m_height(0), m_events_available(false), m_redraw_needed(false), m_is_loading(false), m_stop_audio_thread(false), m_flush_audio_buffer(false), m_av_sync_started(false), m_sample_rate(48000), m_channels(2), m_total_audio_frames(0), m_audio_start_ts(0) {
+	// Only settings are read here; mpv itself is created by ensure_mpv()
 	// Get OBS audio sample rate
 	obs_audio_info oai;
 	if (obs_get_audio_info(&oai)) {
 		m_sample_rate = oai.samples_per_sec;
 	}
 
-	mpv_set_option_string(m_mpv, "vo", "libmpv");
-	mpv_set_option_string(m_mpv, "hwdec", "auto");
+	m_audio_match_obs = obs_data_get_bool(settings, "audio_match_obs");
+	m_resample_quality = (int)obs_data_get_int(settings, "resample_quality");
+	m_clip_cache.set_limit_mb((int)obs_data_get_int(settings, "clip_cache_mb"));
+	set_history_limit((int)obs_data_get_int(settings, "frame_history_mb"));
 
-	// Configure Audio to FIFO (RAW PCM)
-	mpv_set_option_string(m_mpv, "ao", "pcm");
-	mpv_set_option_string(m_mpv, "ao-pcm-file", m_fifo_path.c_str());
-	mpv_set_option_string(m_mpv, "ao-pcm-format", "float");
-	
-	// Keep multi-channel support but set defaults
-	    mpv_set_option_string(m_mpv, "audio-format", "float");
-	    mpv_set_option_string(m_mpv, "keep-open", "yes");
-	
-	    mpv_initialize(m_mpv);
-	
 	    // Load Sub Settings
 	    m_sub_style.font = obs_data_get_string(settings, "sub_font");
 	    if (m_sub_style.font.empty()) m_sub_style.font = "Arial";
@@ -214,191 +832,350 @@ ObsMpvSource::ObsMpvSource(obs_source_t *source, obs_data_t *settings) : m_sourc
 	    m_sub_style.font_size = (int)obs_data_get_int(settings, "sub_font_size");
 	    if (m_sub_style.font_size <= 0) m_sub_style.font_size = 55;
 	    m_sub_style.shadow_offset = (int)obs_data_get_int(settings, "sub_shadow_offset");
-	    
-	    set_sub_style(m_sub_style);
-	
-	    int adv = 1;
-	    mpv_render_param p[] = {{MPV_RENDER_PARAM_API_TYPE, (void *)MPV_RENDER_API_TYPE_SW}, {MPV_RENDER_PARAM_ADVANCED_CONTROL, &adv}, {MPV_RENDER_PARAM_INVALID, nullptr}};	mpv_render_context_create(&m_mpv_render_ctx, m_mpv, p);
-
-	mpv_set_wakeup_callback(m_mpv, on_mpv_wakeup, this);
-	mpv_render_context_set_update_callback(m_mpv_render_ctx, on_mpv_render_update, this);
 
-	m_auto_obs_fps = obs_data_get_bool(settings, "auto_obs_fps");
+	m_fps_mode = fps_mode_setting(settings);
+	m_seek_mode = std::clamp((int)obs_data_get_int(settings, "seek_mode"), (int)SEEK_MODE_FAST, (int)SEEK_MODE_EXACT);
+	m_audio_planar = obs_data_get_bool(settings, "audio_planar");
+	m_hidden_video_mode = (int)obs_data_get_int(settings, "hidden_video");
 	m_restart_on_activate = obs_data_get_bool(settings, "restart_on_activate");
+	m_idle_release_ns = (uint64_t)std::max<long long>(obs_data_get_int(settings, "idle_release"), 0) * 1000000000ULL;
+	update_frame_queue((int)obs_data_get_int(settings, "frame_queue"), (int)obs_data_get_int(settings, "frame_queue_mb"));
+	update_render_size(settings);
+	update_image_settings(settings);
 	load_playlist(settings);
-
-	m_audio_thread = std::thread(&ObsMpvSource::audio_thread_func, this);
+	apply_loudness_settings(settings);
+
+	proc_handler_t *ph = obs_source_get_proc_handler(m_source);
+	proc_handler_add(ph, "void get_stats(out int frames_rendered, out int frames_dropped, out int frames_repeated, "
+			     "out float render_ms_last, out float render_ms_avg, out float render_ms_max, "
+			     "out float decoder_fps, out float container_fps, out float audio_queue_ms, "
+			     "out int audio_underruns, out float av_offset_ms, out float probe_ms_last, out float probe_ms_avg, "
+			     "out int frame_queue_depth, out int frame_queue_capacity, out int frame_spikes, out int spikes_absorbed, "
+			     "out int frames_unchanged, out int clip_cache_hits, out int clip_cache_misses, out float clip_cache_mb, "
+			     "out string hwdec_current, out int video_width, out int video_height, out int output_width, "
+			     "out int output_height, out bool mpv_live, out int mpv_releases, out int live_instances, "
+			     "out int instance_limit, out bool loudness_measured, out float loudness_lufs, out float true_peak_db, "
+			     "out float auto_gain_db, out int commands_sent, out int commands_coalesced, out int commands_failed, "
+			     "out int commands_in_flight, out float seek_ms_last, out float seek_ms_avg, out int seeks, "
+			     "out int history_frames, out float history_mb, out int steps_cached, out int steps_decoded, "
+			     "out int shuttle)",
+			 proc_get_stats, this);
 }
 
 ObsMpvSource::~ObsMpvSource() {
+	// Before any member a load job touches goes away
+	m_load_tasks.cancel();
+	m_load_tasks.wait();
+
+	MpvLock lock(m_mpv_mutex);
+	destroy_mpv();
+}
+
+bool ObsMpvSource::ensure_mpv() {
+	MpvLock lock(m_mpv_mutex);
+	if (m_mpv) return true;
+	if (!mpv_budget_acquire(&m_budget)) {
+		m_mpv_wanted = true;
+		return false;
+	}
+	m_budget.idle_since_ns = 0;
+	obs_data_t *settings = obs_source_get_settings(m_source);
+	bool ok = create_mpv(settings);
+	obs_data_release(settings);
+	if (!ok) mpv_budget_release(&m_budget);
+	m_mpv_wanted = !ok;
+	return ok;
+}
+
+void ObsMpvSource::destroy_mpv() {
+	if (!m_mpv) return;
+	stop_render_worker();
+	{
+		std::lock_guard<std::mutex> render_lock(m_render_mutex);
+		mpv_render_context_free(m_mpv_render_ctx);
+		m_mpv_render_ctx = nullptr;
+		std::vector<uint8_t>().swap(m_sw_buffer);
+	}
+	m_commands.attach(nullptr);
+
+	// The audio thread keeps reading (without output) until mpv is gone: mpv's
+	// AO blocks writing into a full pipe, and terminate waits for the AO
+	m_av_sync_started = false;
+	mpv_terminate_destroy(m_mpv.exchange(nullptr));
+
+	// mpv has closed its end of the pipe by now; interrupt() also wakes a
+	// reader still waiting for mpv to open it
 	m_stop_audio_thread = true;
+	m_audio_pipe->interrupt();
 	if (m_audio_thread.joinable()) m_audio_thread.join();
+	m_audio_pipe.reset();
+	mpv_budget_release(&m_budget);
+	m_budget.idle_since_ns = 0;
+
+	// Everything below is rebuilt with the next instance
+	{
+		std::lock_guard<std::mutex> lock(m_audio_mutex);
+		m_audio_queue.clear();
+		m_audio_queue.shrink_to_fit();
+	}
+	std::vector<uint8_t>().swap(m_prev_frame);
+	std::vector<uint8_t>().swap(m_blend_buffer);
+	m_history.release();
+	m_history_prepend = m_history_skip = false;
+	std::vector<uint8_t>().swap(m_audio_out_buf);
+	std::vector<float>().swap(m_audio_planar_buf);
+	reset_conform();
+	m_av_sync_started = false;
+	m_core_idle = true;
+	m_events_available = false;
+	m_is_loading = false;
+	m_last_output_hash = 0;
+	m_video_track_disabled = false;
+}
 
-	#ifdef _WIN32
-	if (m_pipe_handle != INVALID_HANDLE_VALUE) {
-		DisconnectNamedPipe(m_pipe_handle);
-		CloseHandle(m_pipe_handle);
+void ObsMpvSource::check_idle() {
+	uint64_t now = os_gettime_ns();
+	if (now < m_next_idle_check_ns) return;
+	m_next_idle_check_ns = now + 1000000000ULL;
+
+	if (!m_mpv) {
+		// Refused by the instance limit earlier; take a slot once one frees up
+		if (!m_mpv_wanted || !(m_showing || m_active) || !ensure_mpv()) return;
+		int pending = m_pending_play;
+		m_pending_play = -1;
+		if (pending >= 0) playlist_play(pending);
+		else resume_released(!m_active);
+		return;
 	}
-	#else
-	unlink(m_fifo_path.c_str());
-	#endif
 
-	if (m_mpv_render_ctx) mpv_render_context_free(m_mpv_render_ctx);
-	mpv_terminate_destroy(m_mpv);
+	bool idle = !m_image_active && !m_is_loading && (is_idle() || (!m_showing && !m_active && !is_playing()));
+	if (!idle) {
+		m_budget.idle_since_ns = 0;
+		return;
+	}
+	if (!m_budget.idle_since_ns) m_budget.idle_since_ns = now;
+	bool timed_out = m_idle_release_ns > 0 && now - m_budget.idle_since_ns >= m_idle_release_ns;
+	if (timed_out || m_budget.release_requested) release_mpv();
 }
 
-void ObsMpvSource::audio_thread_func() {
-	const size_t chunk_size = 4096;
-	std::vector<uint8_t> buf(chunk_size);
+void ObsMpvSource::release_mpv() {
+	m_resume_index = -1;
+	if (!is_idle() && m_current_index >= 0 && (size_t)m_current_index < m_playlist.size()) {
+		// FILE_LOADED seeks back here when the item is loaded again
+		m_playlist[m_current_index].last_seek_pos = get_time_pos();
+		m_resume_index = m_current_index;
+	}
+	obs_log(LOG_INFO, "Releasing idle mpv instance (%s)",
+		m_budget.release_requested ? "instance limit reached" : "idle timeout");
+	destroy_mpv();
+	m_stats.mpv_releases.fetch_add(1, std::memory_order_relaxed);
+}
 
-#ifdef _WIN32
-	if (m_pipe_handle == INVALID_HANDLE_VALUE) return;
-	BOOL connected = ConnectNamedPipe(m_pipe_handle, NULL) ? TRUE : (GetLastError() == ERROR_PIPE_CONNECTED);
+void ObsMpvSource::resume_released(bool paused) {
+	if (m_resume_index < 0 || !m_mpv) return;
+	playlist_play(m_resume_index);
+	if (paused) m_commands.set_latest("pause", "yes");
+}
 
-	while (!m_stop_audio_thread && connected) {
-		if (m_flush_audio_buffer) {
-			COMMTIMEOUTS timeouts = {0};
-			timeouts.ReadIntervalTimeout = MAXDWORD;
-			timeouts.ReadTotalTimeoutConstant = 1;
-			timeouts.ReadTotalTimeoutMultiplier = 0;
-			SetCommTimeouts(m_pipe_handle, &timeouts);
-
-			DWORD bytes_read_drain = 0;
-			while (ReadFile(m_pipe_handle, buf.data(), (DWORD)chunk_size, &bytes_read_drain, NULL) && bytes_read_drain > 0);
-			
-			std::lock_guard<std::mutex> lock(m_audio_mutex);
-			m_audio_queue.clear();
-			m_flush_audio_buffer = false;
+bool ObsMpvSource::create_mpv(obs_data_t *settings) {
+	MPV_TRACE_SCOPE("create_mpv");
+	uint64_t start = os_gettime_ns();
+	mpv_handle *mpv = mpv_create();
+	if (!mpv) {
+		obs_log(LOG_ERROR, "Could not create mpv instance");
+		return false;
+	}
+	m_audio_pipe = std::make_unique<MpvAudioPipe>();
+	mpv_request_log_messages(mpv, "info");
 
-			timeouts.ReadTotalTimeoutConstant = 0;
-			SetCommTimeouts(m_pipe_handle, &timeouts);
-		}
+	// Published before mpv_initialize so the option helpers below can use it;
+	// nothing renders until the render context exists.
+	m_mpv = mpv;
+	mpv_set_option_string(m_mpv, "vo", "libmpv");
+	apply_decoder_settings(settings);
 
-		DWORD bytes_read = 0;
-		BOOL success = ReadFile(m_pipe_handle, buf.data(), (DWORD)chunk_size, &bytes_read, NULL);
+	// Configure Audio to anonymous pipe (RAW PCM, no WAV header in the stream)
+	mpv_set_option_string(m_mpv, "ao", "pcm");
+	mpv_set_option_string(m_mpv, "ao-pcm-file", m_audio_pipe->path().c_str());
+	mpv_set_option_string(m_mpv, "ao-pcm-waveheader", "no");
+	mpv_set_option_string(m_mpv, "ao-pcm-format", "float");
+	
+	// Keep multi-channel support, limited to layouts OBS can take directly
+	    mpv_set_option_string(m_mpv, "audio-format", "float");
+	    mpv_set_option_string(m_mpv, "keep-open", "yes");
+	mpv_set_option_string(m_mpv, "hr-seek", m_seek_mode == SEEK_MODE_EXACT ? "yes" : "no");
+	apply_audio_output_format();
+	
+	    mpv_initialize(m_mpv);
+	m_clip_cache.attach(m_mpv);
+	m_commands.attach(m_mpv);
+	apply_sub_style();
+	
+	    int adv = 1;
+	    mpv_render_param p[] = {{MPV_RENDER_PARAM_API_TYPE, (void *)MPV_RENDER_API_TYPE_SW}, {MPV_RENDER_PARAM_ADVANCED_CONTROL, &adv}, {MPV_RENDER_PARAM_INVALID, nullptr}};
+	{
+		std::lock_guard<std::mutex> render_lock(m_render_mutex); // A tick may be checking it already
+		mpv_render_context_create(&m_mpv_render_ctx, m_mpv, p);
+	}
 
-		if (success && bytes_read > 0) {
-			std::lock_guard<std::mutex> lock(m_audio_mutex);
-			m_audio_queue.insert(m_audio_queue.end(), buf.begin(), buf.begin() + bytes_read);
-		}
-		
-		if (m_av_sync_started) {
-			uint32_t rate = m_sample_rate;
-			int chans = m_channels;
-			uint64_t start_ts = m_audio_start_ts;
-			
-			std::lock_guard<std::mutex> lock(m_audio_mutex);
-			uint64_t now = os_gettime_ns();
-			if (now >= start_ts && rate > 0 && chans > 0) {
-				uint64_t elapsed_ns = now - start_ts;
-				uint64_t target_frames = util_mul_div64(elapsed_ns, rate, 1000000000ULL);
-				target_frames += rate / 10; // 100ms buffer ahead
-
-				while (m_audio_queue.size() >= (size_t)(chans * sizeof(float)) && m_total_audio_frames < target_frames) {
-					// Adaptive chunk size to ensure we don't split a single multi-channel frame
-					size_t current_chunk = std::min(m_audio_queue.size(), chunk_size);
-					current_chunk -= (current_chunk % (chans * sizeof(float)));
-					if (current_chunk == 0) break;
-
-					struct obs_source_audio audio = {};
-					audio.samples_per_sec = rate;
-					
-					if (chans == 1) audio.speakers = SPEAKERS_MONO;
-					else if (chans == 3) audio.speakers = SPEAKERS_2POINT1;
-					else if (chans == 4) audio.speakers = SPEAKERS_4POINT0;
-					else if (chans == 5) audio.speakers = SPEAKERS_4POINT1;
-					else if (chans == 6) audio.speakers = SPEAKERS_5POINT1;
-					else if (chans == 8) audio.speakers = SPEAKERS_7POINT1;
-					else audio.speakers = SPEAKERS_STEREO;
-
-					audio.format = AUDIO_FORMAT_FLOAT;
-					
-					std::vector<uint8_t> out_buf(m_audio_queue.begin(), m_audio_queue.begin() + current_chunk);
-					m_audio_queue.erase(m_audio_queue.begin(), m_audio_queue.begin() + current_chunk);
-					
-					uint32_t frames = (uint32_t)(current_chunk / sizeof(float) / chans);
-					audio.data[0] = out_buf.data();
-					audio.frames = frames;
-					audio.timestamp = start_ts + util_mul_div64(m_total_audio_frames, 1000000000ULL, rate);
+	mpv_observe_property(m_mpv, 0, "core-idle", MPV_FORMAT_FLAG);
+	mpv_set_wakeup_callback(m_mpv, on_mpv_wakeup, this);
+	mpv_render_context_set_update_callback(m_mpv_render_ctx, on_mpv_render_update, this);
 
-					m_total_audio_frames += frames;
-					obs_source_output_audio(m_source, &audio);
-				}
-			}
-		}
-	}
-	DisconnectNamedPipe(m_pipe_handle);
-#else
-	int fd = open(m_fifo_path.c_str(), O_RDONLY | O_NONBLOCK);
-	int retries = 50;
-	while (fd < 0 && !m_stop_audio_thread && retries-- > 0) {
-		fd = open(m_fifo_path.c_str(), O_RDONLY | O_NONBLOCK);
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
-	if (fd < 0) return;
+	m_video_track_disabled = false;
+	update_video_track();
+	update_frame_queue(m_frame_queue_depth, m_frame_queue_mb); // Starts the render worker if enabled
+
+	m_stop_audio_thread = false;
+	m_audio_thread = std::thread(&ObsMpvSource::audio_thread_func, this);
+	obs_log(LOG_INFO, "mpv instance created in %.1f ms", (os_gettime_ns() - start) / 1e6);
+	return true;
+}
+
+void ObsMpvSource::audio_thread_func() {
+	const size_t chunk_size = 4096;
+	std::vector<uint8_t> buf(chunk_size);
+	mpv_trace_thread_name("mpv audio");
+
+	if (!m_audio_pipe->connect()) return;
 
 	while (!m_stop_audio_thread) {
 		if (m_flush_audio_buffer) {
-			while (read(fd, buf.data(), chunk_size) > 0);
+			m_audio_pipe->drain();
 			std::lock_guard<std::mutex> lock(m_audio_mutex);
 			m_audio_queue.clear();
 			m_flush_audio_buffer = false;
 		}
 
-		ssize_t bytes_read = read(fd, buf.data(), chunk_size);
+		int64_t bytes_read = m_audio_pipe->read(buf.data(), chunk_size);
 		if (bytes_read > 0) {
-			std::lock_guard<std::mutex> lock(m_audio_mutex);
-			m_audio_queue.insert(m_audio_queue.end(), buf.begin(), buf.begin() + bytes_read);
+			{
+				std::lock_guard<std::mutex> lock(m_audio_mutex);
+				m_audio_queue.insert(m_audio_queue.end(), buf.begin(), buf.begin() + bytes_read);
+				m_stats.audio_queue_bytes.store(m_audio_queue.size(), std::memory_order_relaxed);
+			}
+			if (!m_av_sync_started && !m_is_loading && !video_frames_expected()) start_av_sync(os_gettime_ns());
 		} else {
+#ifdef _WIN32
+			if (bytes_read < 0) break; // Reads block on Windows, so this is a broken pipe
+#else
 			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+#endif
 		}
 
-		if (m_av_sync_started) {
-			uint32_t rate = m_sample_rate;
-			int chans = m_channels;
-			uint64_t start_ts = m_audio_start_ts;
+		if (m_av_sync_started) output_queued_audio(chunk_size);
+	}
+}
+
+void ObsMpvSource::output_queued_audio(size_t chunk_size) {
+	uint32_t rate = m_sample_rate;
+	int chans = m_channels;
+	bool planar = m_audio_planar;
 
-			std::lock_guard<std::mutex> lock(m_audio_mutex);
-			uint64_t now = os_gettime_ns();
-			if (now >= start_ts && rate > 0 && chans > 0) {
-				uint64_t elapsed_ns = now - start_ts;
-				uint64_t target_frames = util_mul_div64(elapsed_ns, rate, 1000000000ULL);
-				target_frames += rate / 10; 
-
-				while (m_audio_queue.size() >= (size_t)(chans * sizeof(float)) && m_total_audio_frames < target_frames) {
-					// Adaptive chunk size to avoid cutting frames
-					size_t current_chunk = std::min(m_audio_queue.size(), chunk_size);
-					current_chunk -= (current_chunk % (chans * sizeof(float)));
-					if (current_chunk == 0) break;
-
-					struct obs_source_audio audio = {};
-					audio.samples_per_sec = rate;
-					audio.speakers = (chans == 1) ? SPEAKERS_MONO : (chans == 6) ? SPEAKERS_5POINT1 : SPEAKERS_STEREO;
-					audio.format = AUDIO_FORMAT_FLOAT;
-					
-					std::vector<uint8_t> out_buf(m_audio_queue.begin(), m_audio_queue.begin() + current_chunk);
-					m_audio_queue.erase(m_audio_queue.begin(), m_audio_queue.begin() + current_chunk);
-					
-					uint32_t frames = (uint32_t)(current_chunk / sizeof(float) / chans);
-					audio.data[0] = out_buf.data();
-					audio.frames = frames;
-					audio.timestamp = start_ts + util_mul_div64(m_total_audio_frames, 1000000000ULL, rate);
+	std::lock_guard<std::mutex> lock(m_audio_mutex);
+	uint64_t start_ts = m_audio_start_ts; // Anchored under the lock (see start_av_sync)
+	uint64_t now = os_gettime_ns();
+	if (now < start_ts || rate == 0 || chans <= 0) return;
 
-					m_total_audio_frames += frames;
-					obs_source_output_audio(m_source, &audio);
-				}
+	enum speaker_layout speakers = mpv_audio_speakers(chans);
+	if (speakers == SPEAKERS_UNKNOWN) {
+		// mpv is restricted to MPV_AUDIO_CHANNEL_LAYOUTS, so this is only stale data
+		m_audio_queue.clear();
+		return;
+	}
+
+	uint64_t elapsed_ns = now - start_ts;
+	uint64_t target_frames = util_mul_div64(elapsed_ns, rate, 1000000000ULL);
+	target_frames += rate / 10; // 100ms buffer ahead
+
+	const size_t frame_bytes = chans * sizeof(float);
+	while (m_audio_queue.size() >= frame_bytes && m_total_audio_frames < target_frames) {
+		// Adaptive chunk size to ensure we don't split a single multi-channel frame
+		size_t current_chunk = std::min(m_audio_queue.size(), chunk_size);
+		current_chunk -= (current_chunk % frame_bytes);
+		if (current_chunk == 0) break;
+
+		m_audio_out_buf.assign(m_audio_queue.begin(), m_audio_queue.begin() + current_chunk);
+		m_audio_queue.erase(m_audio_queue.begin(), m_audio_queue.begin() + current_chunk);
+
+		uint32_t frames = (uint32_t)(current_chunk / frame_bytes);
+		float gain = m_audio_gain.load(std::memory_order_relaxed);
+		if (gain != 1.0f) mpv_audio_apply_gain((float *)m_audio_out_buf.data(), (size_t)frames * chans, gain);
+		MPV_TRACE_SCOPE("audio_chunk", frames);
+		update_levels((const float *)m_audio_out_buf.data(), frames, chans, rate);
+
+		struct obs_source_audio audio = {};
+		audio.samples_per_sec = rate;
+		audio.speakers = speakers;
+		audio.frames = frames;
+		audio.timestamp = start_ts + util_mul_div64(m_total_audio_frames, 1000000000ULL, rate);
+
+		if (planar && chans > 1) {
+			m_audio_planar_buf.resize((size_t)frames * chans);
+			float *planes[MAX_AUDIO_CHANNELS];
+			for (int c = 0; c < chans; c++) {
+				planes[c] = m_audio_planar_buf.data() + (size_t)c * frames;
+				audio.data[c] = (const uint8_t *)planes[c];
 			}
+			mpv_audio_deinterleave((const float *)m_audio_out_buf.data(), planes, frames, chans);
+			audio.format = AUDIO_FORMAT_FLOAT_PLANAR;
+		} else {
+			audio.data[0] = m_audio_out_buf.data();
+			audio.format = AUDIO_FORMAT_FLOAT;
 		}
+
+		m_total_audio_frames += frames;
+		obs_source_output_audio(m_source, &audio);
 	}
-	close(fd);
-#endif
+	m_stats.audio_queue_bytes.store(m_audio_queue.size(), std::memory_order_relaxed);
+
+	// Underrun: mpv is playing but everything it gave us is already out and
+	// we have fallen behind the wall clock. Counted once per episode.
+	uint64_t realtime_frames = target_frames - rate / 10;
+	bool starved = m_audio_queue.size() < frame_bytes && !m_core_idle && m_total_audio_frames + rate / 20 < realtime_frames;
+	if (starved && !m_audio_underrun) m_stats.audio_underruns.fetch_add(1, std::memory_order_relaxed);
+	m_audio_underrun = starved;
+}
+
+void ObsMpvSource::update_levels(const float *samples, uint32_t frames, int channels, uint32_t rate) {
+	float peak[MAX_AUDIO_CHANNELS], sum_sq[MAX_AUDIO_CHANNELS];
+	mpv_audio_measure(samples, frames, channels, peak, sum_sq);
+
+	// Per-chunk ballistics; the audio thread is the only writer, so each
+	// channel is a plain load and store
+	double dt = (double)frames / rate;
+	float fall = (float)std::pow(10.0, -20.0 * dt / 20.0);
+	float smooth = (float)(1.0 - std::exp(-dt / 0.3));
+	bool layout_changed = m_level_channels.load(std::memory_order_relaxed) != channels;
+	for (int c = 0; c < channels; c++) {
+		float held = layout_changed ? 0.0f : m_level_peak[c].load(std::memory_order_relaxed) * fall;
+		float ms = layout_changed ? 0.0f : m_level_ms[c].load(std::memory_order_relaxed);
+		m_level_peak[c].store(std::max(peak[c], held), std::memory_order_relaxed);
+		m_level_ms[c].store(ms + smooth * (sum_sq[c] / frames - ms), std::memory_order_relaxed);
+	}
+	m_level_channels.store(channels, std::memory_order_relaxed);
+	m_level_time_ns.store(os_gettime_ns(), std::memory_order_release);
+}
+
+ObsMpvSource::AudioLevels ObsMpvSource::get_audio_levels() const {
+	AudioLevels levels;
+	uint64_t time_ns = m_level_time_ns.load(std::memory_order_acquire);
+	if (!time_ns || os_gettime_ns() - time_ns > 300000000ULL) return levels; // Nothing going out
+	levels.channels = std::min(m_level_channels.load(std::memory_order_relaxed), MAX_AUDIO_CHANNELS);
+	for (int c = 0; c < levels.channels; c++) {
+		levels.peak[c] = m_level_peak[c].load(std::memory_order_relaxed);
+		levels.rms[c] = std::sqrt(m_level_ms[c].load(std::memory_order_relaxed));
+	}
+	return levels;
 }
 
 void ObsMpvSource::handle_mpv_events() {
+	MPV_TRACE_SCOPE("mpv_events");
 	bool tracks_changed = false;
 	while (m_mpv) {
 		mpv_event *event = mpv_wait_event(m_mpv, 0);
 		if (event->event_id == MPV_EVENT_NONE) break;
+		MPV_TRACE_SCOPE("event_dispatch", event->event_id);
 
 		if (event->event_id == MPV_EVENT_LOG_MESSAGE) {
 			auto msg = static_cast<mpv_event_log_message*>(event->data);
@@ -409,21 +1186,46 @@ void ObsMpvSource::handle_mpv_events() {
 			blog(obs_level, "[libmpv] %s: %s", msg->prefix, msg->text);
 		}
 
+		if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+			auto prop = static_cast<mpv_event_property*>(event->data);
+			if (!strcmp(prop->name, "core-idle") && prop->format == MPV_FORMAT_FLAG)
+				m_core_idle = *static_cast<int*>(prop->data) != 0;
+		}
+
+		m_commands.handle_reply(event);
+
+		if (event->event_id == MPV_EVENT_PLAYBACK_RESTART && m_seek_request_ns) m_seek_restarted = true;
+
+		if (event->event_id == MPV_EVENT_SEEK) {
+			if (m_render_worker_active) flush_frame_queue();
+			reset_conform();
+		}
+
 		if (event->event_id == MPV_EVENT_VIDEO_RECONFIG) {
+			update_has_video(); // Also when the track is switched off while hidden
 			int64_t w, h;
 			mpv_get_property(m_mpv, "width", MPV_FORMAT_INT64, &w);
 			mpv_get_property(m_mpv, "height", MPV_FORMAT_INT64, &h);
-			m_width = (uint32_t)w; m_height = (uint32_t)h;
+			if (w > 0 && h > 0) {
+				m_native_width = (uint32_t)w;
+				m_native_height = (uint32_t)h;
+				uint32_t out_w, out_h;
+				fit_render_size((uint32_t)w, (uint32_t)h, out_w, out_h);
+				m_width = out_w;
+				m_height = out_h;
+			}
+			reset_conform();
 		} else if (event->event_id == MPV_EVENT_AUDIO_RECONFIG) {
 			int64_t new_rate = 0, new_chans = 0;
-			mpv_get_property(m_mpv, "audio-params/samplerate", MPV_FORMAT_INT64, &new_rate);
-			mpv_get_property(m_mpv, "audio-params/channel-count", MPV_FORMAT_INT64, &new_chans);
+			mpv_get_property(m_mpv, "audio-out-params/samplerate", MPV_FORMAT_INT64, &new_rate);
+			mpv_get_property(m_mpv, "audio-out-params/channel-count", MPV_FORMAT_INT64, &new_chans);
 			
 			if (new_rate > 0 && new_chans > 0) {
 				if (m_sample_rate != (uint32_t)new_rate || m_channels != (int)new_chans) {
 					blog(LOG_INFO, "[obs-mpv] Audio reconfig during playback: %" PRId64 " Hz, %" PRId64 " channels", new_rate, new_chans);
 					
 					// Reset sync anchor to prevent drift
+					std::lock_guard<std::mutex> lock(m_audio_mutex);
 					if (m_av_sync_started) {
 						uint64_t current_ts = m_audio_start_ts + util_mul_div64(m_total_audio_frames, 1000000000ULL, m_sample_rate);
 						m_audio_start_ts = current_ts;
@@ -438,15 +1240,35 @@ void ObsMpvSource::handle_mpv_events() {
 		}
 		if (event->event_id == MPV_EVENT_FILE_LOADED) {
 			obs_log(LOG_INFO, "MPV: File Loaded");
+			mpv_trace_instant("file_loaded", m_current_index);
+			if (m_render_worker_active) flush_frame_queue();
+			reset_conform();
+			apply_video_timing(); // Lookahead depends on the new file's frame rate
+			{
+				// Only capture once the image itself is loaded, not a frame of
+				// whatever was still playing when it was requested
+				std::lock_guard<std::mutex> lock(m_image_mutex);
+				char *loaded = mpv_get_property_string(m_mpv, "path");
+				if (m_image_capture_armed && loaded && m_image_path == loaded) {
+					m_image_capture_armed = false;
+					m_image_capture = true;
+				}
+				mpv_free(loaded);
+			}
 			m_is_loading = false;
 			tracks_changed = true;
-			m_total_audio_frames = 0;
-			m_audio_start_ts = 0;
-			m_av_sync_started = false;
+			{
+				std::lock_guard<std::mutex> lock(m_audio_mutex);
+				m_total_audio_frames = 0;
+				m_audio_start_ts = 0;
+				m_av_sync_started = false;
+			}
+			m_last_output_hash = 0; // The new item's first frame always goes out
+			update_has_video();
 
 			int64_t new_rate = 0, new_chans = 0;
-			mpv_get_property(m_mpv, "audio-params/samplerate", MPV_FORMAT_INT64, &new_rate);
-			mpv_get_property(m_mpv, "audio-params/channel-count", MPV_FORMAT_INT64, &new_chans);
+			mpv_get_property(m_mpv, "audio-out-params/samplerate", MPV_FORMAT_INT64, &new_rate);
+			mpv_get_property(m_mpv, "audio-out-params/channel-count", MPV_FORMAT_INT64, &new_chans);
 			if (new_rate > 0) m_sample_rate = (uint32_t)new_rate;
 			if (new_chans > 0) m_channels = (int)new_chans;
 
@@ -493,71 +1315,199 @@ void ObsMpvSource::playlist_add(const std::string& path) {
 }
 
 void ObsMpvSource::playlist_add_multiple(const std::vector<std::string>& paths) {
+	MpvLock lock(m_mpv_mutex);
 	obs_log(LOG_INFO, "Adding %zu files to playlist", paths.size());
-	mpv_handle *probe_mpv = mpv_create();
-	if (!probe_mpv) return;
-
-	mpv_set_option_string(probe_mpv, "vo", "null");
-	mpv_set_option_string(probe_mpv, "ao", "null");
-	mpv_set_option_string(probe_mpv, "idle", "yes");
-	if (mpv_initialize(probe_mpv) < 0) {
-		mpv_terminate_destroy(probe_mpv);
-		return;
+	// Items show up right away; duration, fps and tracks follow once the
+	// pool has probed them
+	for (const auto& path : paths) {
+		PlaylistItem item;
+		item.path = path;
+		size_t last_slash = path.find_last_of("/\\");
+		item.name = (last_slash == std::string::npos) ? path : path.substr(last_slash + 1);
+		if (is_image_path(path)) {
+			item.is_image = true;
+			item.image_duration = m_default_image_duration;
+			item.duration = item.image_duration;
+		} else {
+			queue_load(LoadJob{path, true, false, MpvTaskPriority::Interactive});
+		}
+		m_playlist.push_back(item);
 	}
+	if (m_auto_gain) request_loudness();
+}
 
-	for (const auto& path : paths) {
-		FileMetadata meta = {0.0, 0.0, 0, {}, {}};
-		const char *cmd[] = {"loadfile", path.c_str(), nullptr};
-		mpv_command(probe_mpv, cmd);
-
-		while (true) {
-			mpv_event *event = mpv_wait_event(probe_mpv, 1.0);
-			if (event->event_id == MPV_EVENT_FILE_LOADED) {
-				mpv_get_property(probe_mpv, "duration", MPV_FORMAT_DOUBLE, &meta.duration);
-				mpv_get_property(probe_mpv, "container-fps", MPV_FORMAT_DOUBLE, &meta.fps);
-				mpv_get_property(probe_mpv, "audio-params/channel-count", MPV_FORMAT_INT64, &meta.channels);
-
-				mpv_node node;
-				if (mpv_get_property(probe_mpv, "track-list", MPV_FORMAT_NODE, &node) == 0) {
-					if (node.format == MPV_FORMAT_NODE_ARRAY) {
-						for (int i = 0; i < node.u.list->num; i++) {
-							mpv_node *tr = &node.u.list->values[i];
-							const char *t=nullptr, *l=nullptr; int64_t id=-1;
-							for (int j=0; j<tr->u.list->num; j++) {
-								const char *k = tr->u.list->keys[j]; mpv_node *v = &tr->u.list->values[j];
-								if (!strcmp(k, "type")) t=v->u.string;
-								else if (!strcmp(k, "id")) id=v->u.int64;
-								else if (!strcmp(k, "lang")) l=v->u.string;
-							}
-							if (t && !strcmp(t, "audio")) meta.audio_tracks.push_back({(int)id, l ? l : std::to_string(id), false});
-							if (t && !strcmp(t, "sub")) meta.sub_tracks.push_back({(int)id, l ? l : std::to_string(id), false});
+bool ObsMpvSource::probe_with(mpv_handle *probe_mpv, const std::string &path, FileMetadata &meta) {
+	const char *cmd[] = {"loadfile", path.c_str(), nullptr};
+	mpv_command(probe_mpv, cmd);
+
+	while (true) {
+		mpv_event *event = mpv_wait_event(probe_mpv, 1.0);
+		if (event->event_id == MPV_EVENT_FILE_LOADED) {
+			mpv_get_property(probe_mpv, "duration", MPV_FORMAT_DOUBLE, &meta.duration);
+			mpv_get_property(probe_mpv, "container-fps", MPV_FORMAT_DOUBLE, &meta.fps);
+			mpv_get_property(probe_mpv, "audio-params/channel-count", MPV_FORMAT_INT64, &meta.channels);
+
+			mpv_node node;
+			if (mpv_get_property(probe_mpv, "track-list", MPV_FORMAT_NODE, &node) == 0) {
+				if (node.format == MPV_FORMAT_NODE_ARRAY) {
+					for (int i = 0; i < node.u.list->num; i++) {
+						mpv_node *tr = &node.u.list->values[i];
+						const char *t=nullptr, *l=nullptr; int64_t id=-1;
+						for (int j=0; j<tr->u.list->num; j++) {
+							const char *k = tr->u.list->keys[j]; mpv_node *v = &tr->u.list->values[j];
+							if (!strcmp(k, "type")) t=v->u.string;
+							else if (!strcmp(k, "id")) id=v->u.int64;
+							else if (!strcmp(k, "lang")) l=v->u.string;
 						}
+						if (t && !strcmp(t, "audio")) meta.audio_tracks.push_back({(int)id, l ? l : std::to_string(id), false});
+						if (t && !strcmp(t, "sub")) meta.sub_tracks.push_back({(int)id, l ? l : std::to_string(id), false});
 					}
-					mpv_free_node_contents(&node);
 				}
-				break;
-			}
-			if (event->event_id == MPV_EVENT_SHUTDOWN || event->event_id == MPV_EVENT_NONE || event->event_id == MPV_EVENT_END_FILE) {
-				if (event->event_id != MPV_EVENT_FILE_LOADED) break;
+				mpv_free_node_contents(&node);
 			}
+			return true;
 		}
+		if (event->event_id == MPV_EVENT_SHUTDOWN || event->event_id == MPV_EVENT_NONE) return false;
+		// The previous file of a shared probe instance ends with reason STOP;
+		// only an error means this one could not be opened
+		if (event->event_id == MPV_EVENT_END_FILE &&
+		    static_cast<mpv_event_end_file *>(event->data)->reason == MPV_END_FILE_REASON_ERROR)
+			return false;
+	}
+}
 
-		PlaylistItem item;
-		item.path = path;
-		item.duration = meta.duration;
-		item.fps = meta.fps;
-		item.audio_channels = (int)meta.channels;
-		item.audio_tracks = meta.audio_tracks;
-		item.sub_tracks = meta.sub_tracks;
-		size_t last_slash = path.find_last_of("/\\");
-		item.name = (last_slash == std::string::npos) ? path : path.substr(last_slash + 1);
-		m_playlist.push_back(item);
+namespace {
+
+// One probe instance per pool worker, reused across jobs and dropped when
+// the pool runs out of work
+struct ProbeInstance {
+	mpv_handle *mpv = nullptr;
+	mpv_handle *get() {
+		if (mpv) return mpv;
+		mpv = mpv_create();
+		if (!mpv) return nullptr;
+		mpv_set_option_string(mpv, "vo", "null");
+		mpv_set_option_string(mpv, "ao", "null");
+		mpv_set_option_string(mpv, "idle", "yes");
+		if (mpv_initialize(mpv) < 0) reset();
+		return mpv;
+	}
+	void reset() {
+		if (mpv) mpv_terminate_destroy(mpv);
+		mpv = nullptr;
+	}
+	~ProbeInstance() { reset(); }
+};
+thread_local ProbeInstance t_probe;
+
+} // namespace
+
+void ObsMpvSource::queue_load(const LoadJob &job) {
+	{
+		std::lock_guard<std::mutex> lock(m_load_mutex);
+		for (const auto &queued : m_load_jobs)
+			if (queued.path == job.path && queued.probe == job.probe && queued.preload == job.preload) return;
+		m_load_jobs.push_back(job);
+	}
+	MpvWorkerPool::instance().submit(m_load_tasks, job.priority, [this, job] { run_load_job(job); });
+}
+
+void ObsMpvSource::run_load_job(const LoadJob &job) {
+	bool ok = false;
+	FileMetadata meta = {0.0, 0.0, 0, {}, {}};
+	if (job.preload) m_clip_cache.preload(job.path);
+	if (job.probe) {
+		MPV_TRACE_SCOPE("probe");
+		uint64_t probe_start = os_gettime_ns();
+		mpv_handle *probe_mpv = t_probe.get();
+		ok = probe_mpv && probe_with(probe_mpv, job.path, meta);
+		m_stats.add_probe(os_gettime_ns() - probe_start);
+		if (!ok) obs_log(LOG_WARNING, "Could not probe %s", job.path.c_str());
+		if (MpvWorkerPool::instance().idle()) t_probe.reset();
+	}
+
+	std::lock_guard<std::mutex> lock(m_load_mutex);
+	auto it = std::find_if(m_load_jobs.begin(), m_load_jobs.end(), [&](const LoadJob &queued) {
+		return queued.path == job.path && queued.probe == job.probe && queued.preload == job.preload;
+	});
+	if (it != m_load_jobs.end()) m_load_jobs.erase(it);
+	if (ok) {
+		m_probe_results.emplace_back(job.path, std::move(meta));
+		m_probe_results_ready = true;
+	}
+}
+
+void ObsMpvSource::apply_probe_results() {
+	std::vector<std::pair<std::string, FileMetadata>> results;
+	{
+		std::lock_guard<std::mutex> lock(m_load_mutex);
+		results.swap(m_probe_results);
+		m_probe_results_ready = false;
 	}
+	for (auto &result : results) {
+		for (auto &item : m_playlist) {
+			if (item.probed || item.path != result.first) continue;
+			const FileMetadata &meta = result.second;
+			if (item.duration <= 0.0) item.duration = meta.duration;
+			item.fps = meta.fps;
+			item.audio_channels = (int)meta.channels;
+			item.audio_tracks = meta.audio_tracks;
+			item.sub_tracks = meta.sub_tracks;
+			item.probed = true;
+		}
+	}
+	m_playlist_revision++;
+}
+
+void ObsMpvSource::apply_loudness_settings(obs_data_t *settings) {
+	m_auto_gain = obs_data_get_bool(settings, "auto_gain");
+	m_target_lufs = obs_data_get_double(settings, "target_lufs");
+	if (m_auto_gain) request_loudness();
+	update_auto_gain();
+}
+
+void ObsMpvSource::request_loudness() {
+	// Items measured before (saved with the playlist) are not queued again
+	for (const auto &item : m_playlist)
+		if (!item.is_image && !item.loudness_measured) MpvLoudnessAnalyzer::instance().request(item.path);
+}
 
-	    mpv_terminate_destroy(probe_mpv);
+void ObsMpvSource::apply_loudness_results() {
+	auto &analyzer = MpvLoudnessAnalyzer::instance();
+	m_loudness_revision = analyzer.revision();
+	bool changed = false;
+	for (auto &item : m_playlist) {
+		MpvLoudness loudness;
+		if (item.is_image || item.loudness_measured || !analyzer.result(item.path, loudness)) continue;
+		item.loudness_measured = true;
+		item.loudness_lufs = loudness.integrated_lufs;
+		item.true_peak_db = loudness.true_peak_db;
+		changed = true;
 	}
+	if (!changed) return;
+	m_playlist_revision++;
+	update_auto_gain();
+}
+
+void ObsMpvSource::update_auto_gain() {
+	// Unmeasured items play unchanged; a result arriving mid-item applies
+	// right away
+	double gain_db = 0.0;
+	if (m_auto_gain && m_current_index >= 0 && (size_t)m_current_index < m_playlist.size()) {
+		const PlaylistItem &item = m_playlist[m_current_index];
+		if (item.loudness_measured)
+			gain_db = mpv_loudness_gain_db({item.loudness_lufs, item.true_peak_db}, m_target_lufs);
+	}
+	m_audio_gain = (float)std::pow(10.0, gain_db / 20.0);
+}
+
+bool ObsMpvSource::loads_pending() {
+	std::lock_guard<std::mutex> lock(m_load_mutex);
+	return !m_load_jobs.empty() || !m_probe_results.empty();
+}
 	
 	void ObsMpvSource::playlist_play_with_fade(int index, double fade_sec) {
+	    MpvLock lock(m_mpv_mutex);
 	    if (index >= 0 && (size_t)index < m_playlist.size()) {
 	        m_playlist[index].fade_in_enabled = true;
 	        m_playlist[index].fade_in = fade_sec;
@@ -566,12 +1516,15 @@ void ObsMpvSource::playlist_add_multiple(const std::vector<std::string>& paths)
 	}
 	
 	void ObsMpvSource::playlist_restart_with_fade(double fade_sec) {
+	    MpvLock lock(m_mpv_mutex);
 	    if (m_current_index >= 0) {
 	        playlist_play_with_fade(m_current_index, fade_sec);
 	    }
 	}
 	
-	void ObsMpvSource::playlist_remove(int index) {	if (index >= 0 && (size_t)index < m_playlist.size()) {
+	void ObsMpvSource::playlist_remove(int index) {
+	MpvLock lock(m_mpv_mutex);
+	if (index >= 0 && (size_t)index < m_playlist.size()) {
 		m_playlist.erase(m_playlist.begin() + index);
 		if (index == m_current_index) {
 			stop();
@@ -583,6 +1536,7 @@ void ObsMpvSource::playlist_add_multiple(const std::vector<std::string>& paths)
 }
 
 void ObsMpvSource::playlist_move(int from, int to) {
+	MpvLock lock(m_mpv_mutex);
 	if (from >= 0 && (size_t)from < m_playlist.size() && to >= 0 && (size_t)to < m_playlist.size() && from != to) {
 		auto item = m_playlist[from];
 		m_playlist.erase(m_playlist.begin() + from);
@@ -593,21 +1547,76 @@ void ObsMpvSource::playlist_move(int from, int to) {
 	}
 }
 
-void ObsMpvSource::set_auto_obs_fps(bool enabled) { m_auto_obs_fps = enabled; }
-bool ObsMpvSource::get_auto_obs_fps() { return m_auto_obs_fps; }
+void ObsMpvSource::set_auto_obs_fps(bool enabled) { set_fps_mode(enabled ? FPS_MODE_RESET_OBS : FPS_MODE_OFF); }
+bool ObsMpvSource::get_auto_obs_fps() { return m_fps_mode == FPS_MODE_RESET_OBS; }
+
+void ObsMpvSource::set_fps_mode(int mode) {
+	MpvLock lock(m_mpv_mutex);
+	if (mode == m_fps_mode) return;
+	m_fps_mode = mode;
+	apply_video_timing();
+}
+int ObsMpvSource::get_fps_mode() { return m_fps_mode; }
+
+int ObsMpvSource::fps_mode_setting(obs_data_t *settings) {
+	// Older configs only have the auto_obs_fps toggle
+	if (!obs_data_has_user_value(settings, "fps_mode"))
+		return obs_data_get_bool(settings, "auto_obs_fps") ? FPS_MODE_RESET_OBS : FPS_MODE_OFF;
+	return std::clamp((int)obs_data_get_int(settings, "fps_mode"), (int)FPS_MODE_OFF, (int)FPS_MODE_CONFORM_BLEND);
+}
+
+void ObsMpvSource::set_seek_mode(int mode) {
+	mode = std::clamp(mode, (int)SEEK_MODE_FAST, (int)SEEK_MODE_EXACT);
+	if (mode == m_seek_mode) return;
+	m_seek_mode = mode;
+	m_commands.set("hr-seek", mode == SEEK_MODE_EXACT ? "yes" : "no"); // Applied when mpv is created otherwise
+}
+int ObsMpvSource::get_seek_mode() { return m_seek_mode; }
+
+void ObsMpvSource::note_seek_frame(uint64_t now_ns) {
+	if (!m_seek_restarted.exchange(false)) return;
+	uint64_t request_ns = m_seek_request_ns.exchange(0);
+	if (request_ns && now_ns > request_ns) m_stats.add_seek(now_ns - request_ns);
+}
 
 void ObsMpvSource::playlist_play(int index) {
+	MpvLock lock(m_mpv_mutex);
 	if (index >= 0 && (size_t)index < m_playlist.size()) {
+		m_resume_index = -1;
+		if (!ensure_mpv()) {
+			m_pending_play = index;
+			return;
+		}
 		m_flush_audio_buffer = true;
 		obs_log(LOG_INFO, "Playlist Play request: index %d", index);
+		mpv_trace_instant("loadfile", index);
 		m_is_loading = true;
 		m_current_index = index;
+		m_last_output_hash = 0;
+		update_auto_gain();
+		end_shuttle();
+		set_transport_mute(false);
+		m_history_reset = true;
 		auto& item = m_playlist[index];
 
-		const char *cmd[] = {"loadfile", item.path.c_str(), nullptr};
-		mpv_command_async(m_mpv, 0, cmd);
+		{
+			std::lock_guard<std::mutex> lock(m_image_mutex);
+			m_image_active = false;
+			m_image_capture_armed = false;
+			m_image_capture = false;
+		}
+		if (item.is_image) {
+			start_image_item(item);
+			return;
+		}
+
+		m_commands.set("image-display-duration", "1"); // mpv's default, for images not detected as such
+		std::string url = item.preload ? m_clip_cache.play_url(item.path) : item.path;
+		m_commands.drop_pending("time-pos"); // Meant for the previous file
+		m_seek_request_ns = 0;
+		m_commands.command({"loadfile", url.c_str()});
 
-		if (m_auto_obs_fps && item.fps > 0) {
+		if (m_fps_mode == FPS_MODE_RESET_OBS && item.fps > 0) {
 			obs_video_info ovi;
 			if (obs_get_video_info(&ovi)) {
 				uint32_t num = (uint32_t)(item.fps * 100000.0 + 0.5);
@@ -630,16 +1639,13 @@ void ObsMpvSource::playlist_play(int index) {
 			}
 		}
 
-		mpv_set_property_string(m_mpv, "pause", "no");
+		m_commands.set_latest("pause", "no");
 		set_volume(item.volume);
 
-		if (item.audio_track < 0) mpv_set_property_string(m_mpv, "aid", "no");
-		else mpv_set_property_string(m_mpv, "aid", std::to_string(item.audio_track).c_str());
-
-		if (item.sub_track < 0) mpv_set_property_string(m_mpv, "sid", "no");
-		else mpv_set_property_string(m_mpv, "sid", std::to_string(item.sub_track).c_str());
-
-		mpv_set_property_string(m_mpv, "loop-file", item.loop ? "inf" : "no");
+		// Queued behind the loadfile, so they apply to the new file
+		m_commands.set("aid", item.audio_track < 0 ? "no" : std::to_string(item.audio_track).c_str());
+		m_commands.set("sid", item.sub_track < 0 ? "no" : std::to_string(item.sub_track).c_str());
+		m_commands.set("loop-file", item.loop ? "inf" : "no");
 
 		std::string filters = "";
 		if (item.fade_in_enabled && item.fade_in > 0) {
@@ -650,17 +1656,126 @@ void ObsMpvSource::playlist_play(int index) {
 			double start_time = item.duration - item.fade_out;
 			filters += "lavfi=[afade=t=out:st="+ std::to_string(start_time) + ":d="+ std::to_string(item.fade_out) + "]";
 		}
-		if (!filters.empty()) mpv_set_property_string(m_mpv, "af", filters.c_str());
-		else mpv_set_property_string(m_mpv, "af", "");
+		m_commands.set("af", filters.c_str());
+
+		if (!item.ext_sub_path.empty()) m_commands.command({"sub-add", item.ext_sub_path.c_str(), "select"});
+	}
+}
+
+bool ObsMpvSource::is_image_path(const std::string &path) {
+	// Animated formats (gif) stay regular items
+	static const char *const extensions[] = {"jpg", "jpeg", "png", "bmp", "webp", "tif", "tiff", "tga", "avif", "jxl"};
+	size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos) return false;
+	std::string ext = path.substr(dot + 1);
+	for (char &c : ext) c = (char)tolower((unsigned char)c);
+	for (const char *e : extensions)
+		if (ext == e) return true;
+	return false;
+}
+
+void ObsMpvSource::update_image_settings(obs_data_t *settings) {
+	std::lock_guard<std::mutex> lock(m_image_mutex);
+	m_default_image_duration = obs_data_get_double(settings, "image_duration");
+	m_image_cache_mb = (int)obs_data_get_int(settings, "image_cache_mb");
+	evict_cached_images();
+}
+
+void ObsMpvSource::start_image_item(const PlaylistItem &item) {
+	std::lock_guard<std::mutex> lock(m_image_mutex);
+	m_image_path = item.path;
+	m_image_duration_ns = (uint64_t)(std::max(item.image_duration, 0.1) * 1e9);
+	m_image_start_ns = os_gettime_ns();
+	m_image_paused = false;
+	m_image_active = true;
+
+	auto it = m_image_cache.find(item.path);
+	if (it != m_image_cache.end()) {
+		uint32_t w, h;
+		fit_render_size(it->second.native_width, it->second.native_height, w, h);
+		if (w == it->second.width && h == it->second.height) {
+			it->second.last_used = ++m_image_cache_uses;
+			m_image_output_pending = true;
+			m_is_loading = false;
+			m_commands.command({"stop"}); // Release whatever played before
+			return;
+		}
+	}
+
+	// Not cached (or cached for a different render size): decode through mpv
+	// once. The image stays up until our timer moves on, not mpv's.
+	m_image_capture_armed = true;
+	m_commands.set("image-display-duration", "inf");
+	m_commands.command({"loadfile", item.path.c_str()});
+	m_commands.set_latest("pause", "no");
+}
+
+void ObsMpvSource::capture_image_frame(const uint8_t *data, uint32_t width, uint32_t height) {
+	std::lock_guard<std::mutex> lock(m_image_mutex);
+	m_image_capture = false;
+	if (!m_image_active) return;
+
+	CachedImage &img = m_image_cache[m_image_path];
+	size_t bytes = (size_t)width * 4 * height;
+	m_image_cache_bytes -= img.data.size();
+	img.data.assign(data, data + bytes);
+	img.width = width;
+	img.height = height;
+	img.native_width = m_native_width;
+	img.native_height = m_native_height;
+	img.last_used = ++m_image_cache_uses;
+	m_image_cache_bytes += bytes;
+	evict_cached_images();
+
+	// The frame is in OBS and in the cache; the decoder is no longer needed
+	m_commands.command({"stop"});
+}
+
+void ObsMpvSource::evict_cached_images() {
+	// Least recently shown first; never the image currently up
+	size_t cap = (size_t)m_image_cache_mb << 20;
+	while (m_image_cache_bytes > cap && m_image_cache.size() > 1) {
+		auto victim = m_image_cache.end();
+		for (auto it = m_image_cache.begin(); it != m_image_cache.end(); ++it) {
+			if (it->first == m_image_path) continue;
+			if (victim == m_image_cache.end() || it->second.last_used < victim->second.last_used) victim = it;
+		}
+		if (victim == m_image_cache.end()) break;
+		m_image_cache_bytes -= victim->second.data.size();
+		m_image_cache.erase(victim);
+	}
+}
+
+double ObsMpvSource::image_elapsed() {
+	uint64_t now = m_image_paused ? m_image_paused_ns : os_gettime_ns();
+	return now > m_image_start_ns ? (now - m_image_start_ns) / 1e9 : 0.0;
+}
 
-		if (!item.ext_sub_path.empty()) {
-			const char *sub_cmd[] = {"sub-add", item.ext_sub_path.c_str(), "select", nullptr};
-			mpv_command_async(m_mpv, 0, sub_cmd);
+void ObsMpvSource::tick_image() {
+	bool finished = false;
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		if (!m_image_active) return;
+		if (m_image_output_pending) {
+			m_image_output_pending = false;
+			auto it = m_image_cache.find(m_image_path);
+			if (it != m_image_cache.end()) {
+				m_width = it->second.width;
+				m_height = it->second.height;
+				output_video_frame(it->second.data.data(), it->second.width, it->second.height, os_gettime_ns());
+			}
+		}
+		if (!m_image_paused && os_gettime_ns() - m_image_start_ns >= m_image_duration_ns) {
+			m_image_active = false;
+			m_image_capture = false;
+			finished = true;
 		}
 	}
+	if (finished) playlist_next();
 }
 
 void ObsMpvSource::playlist_next() {
+	MpvLock lock(m_mpv_mutex);
 	if (m_current_index >= 0 && (size_t)m_current_index < m_playlist.size()) {
 		if (m_playlist[m_current_index].loop) {
 			playlist_play(m_current_index);
@@ -674,18 +1789,382 @@ void ObsMpvSource::playlist_next() {
 	}
 }
 
-ObsMpvSource::PlaylistItem* ObsMpvSource::playlist_get_item(int index) {
-	if (index >= 0 && (size_t)index < m_playlist.size()) return &m_playlist[index];
-	return nullptr;
+bool ObsMpvSource::playlist_get_item(int index, PlaylistItem &item) {
+	MpvLock lock(m_mpv_mutex);
+	if (index < 0 || (size_t)index >= m_playlist.size()) return false;
+	item = m_playlist[index];
+	return true;
+}
+
+std::vector<ObsMpvSource::PlaylistItem> ObsMpvSource::playlist_items() {
+	MpvLock lock(m_mpv_mutex);
+	return m_playlist;
 }
 
-int ObsMpvSource::playlist_count() { return (int)m_playlist.size(); }
-void ObsMpvSource::play() { mpv_set_property_string(m_mpv, "pause", "no"); }
-void ObsMpvSource::pause() { mpv_set_property_string(m_mpv, "pause", "yes"); }
-void ObsMpvSource::stop() { mpv_command_string(m_mpv, "stop"); }
-void ObsMpvSource::seek(double s) { mpv_set_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &s); }
-double ObsMpvSource::get_time_pos() { double v=0; mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &v); return v; }
-double ObsMpvSource::get_duration() { double v=0; mpv_get_property(m_mpv, "duration", MPV_FORMAT_DOUBLE, &v); return v; }
+bool ObsMpvSource::playlist_edit_item(int index, const std::function<void(PlaylistItem &)> &edit) {
+	MpvLock lock(m_mpv_mutex);
+	if (index < 0 || (size_t)index >= m_playlist.size()) return false;
+	edit(m_playlist[index]);
+	return true;
+}
+
+void ObsMpvSource::playlist_set_preload(int index, bool enabled) {
+	MpvLock lock(m_mpv_mutex);
+	if (index < 0 || (size_t)index >= m_playlist.size()) return;
+	auto &item = m_playlist[index];
+	item.preload = enabled && !item.is_image; // Images have their own frame cache
+	if (item.preload) queue_load(LoadJob{item.path, false, true, MpvTaskPriority::Prefetch});
+}
+
+void ObsMpvSource::apply_decoder_settings(obs_data_t *settings) {
+	// hwdec and threads apply from the next decoder init, the demuxer options
+	// from the next file, so changing them never interrupts playback.
+	if (!m_mpv) return; // Read from the settings when mpv is created
+	const char *hwdec = obs_data_get_string(settings, "hwdec");
+	mpv_set_option_string(m_mpv, "hwdec", *hwdec ? hwdec : "auto");
+	std::string threads = std::to_string(obs_data_get_int(settings, "decoder_threads")); // 0 = auto
+	mpv_set_option_string(m_mpv, "vd-lavc-threads", threads.c_str());
+	std::string max_bytes = std::to_string(std::max<long long>(obs_data_get_int(settings, "demuxer_max_mb"), 8)) + "MiB";
+	mpv_set_option_string(m_mpv, "demuxer-max-bytes", max_bytes.c_str());
+	std::string readahead = std::to_string(obs_data_get_double(settings, "demuxer_readahead"));
+	mpv_set_option_string(m_mpv, "demuxer-readahead-secs", readahead.c_str());
+	const char *framedrop = obs_data_get_string(settings, "framedrop");
+	mpv_set_option_string(m_mpv, "framedrop", *framedrop ? framedrop : "vo");
+}
+
+bool ObsMpvSource::save_decoder_defaults(obs_properties_t *, obs_property_t *, void *data) {
+	auto self = static_cast<ObsMpvSource *>(data);
+	obs_data_t *settings = obs_source_get_settings(self->m_source);
+	obs_data_t *out = obs_data_create();
+	obs_data_set_string(out, "hwdec", obs_data_get_string(settings, "hwdec"));
+	obs_data_set_int(out, "decoder_threads", obs_data_get_int(settings, "decoder_threads"));
+	obs_data_set_int(out, "demuxer_max_mb", obs_data_get_int(settings, "demuxer_max_mb"));
+	obs_data_set_double(out, "demuxer_readahead", obs_data_get_double(settings, "demuxer_readahead"));
+	obs_data_set_string(out, "framedrop", obs_data_get_string(settings, "framedrop"));
+	obs_data_release(settings);
+
+	char *dir = obs_module_config_path("");
+	if (dir) os_mkdirs(dir);
+	bfree(dir);
+	char *path = obs_module_config_path(k_decoder_defaults_file);
+	if (!path || !obs_data_save_json_safe(out, path, "tmp", "bak"))
+		obs_log(LOG_WARNING, "Could not save decoder defaults to %s", path ? path : "(no config path)");
+	else
+		obs_log(LOG_INFO, "Saved decoder defaults for new sources to %s", path);
+	bfree(path);
+	obs_data_release(out);
+	return false;
+}
+
+// mpv takes "." as the decimal separator whatever the process locale is
+static void format_seconds(double s, char *buf, size_t size) {
+	long long us = std::llabs(std::llround(s * 1e6));
+	snprintf(buf, size, "%s%lld.%06lld", s < 0 ? "-" : "", us / 1000000, us % 1000000);
+}
+
+int ObsMpvSource::playlist_count() {
+	MpvLock lock(m_mpv_mutex);
+	return (int)m_playlist.size();
+}
+void ObsMpvSource::play() {
+	MpvLock lock(m_mpv_mutex);
+	check_history_reset();
+	end_shuttle();
+	leave_history();
+	set_transport_mute(false);
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		if (m_image_active && m_image_paused) {
+			m_image_start_ns += os_gettime_ns() - m_image_paused_ns;
+			m_image_paused = false;
+		}
+	}
+	if (!ensure_mpv()) return;
+	if (m_resume_index >= 0) resume_released(false);
+	else m_commands.set_latest("pause", "no");
+}
+void ObsMpvSource::pause() {
+	// No mpv lock: the command queue guards the instance (same for stop,
+	// seek and set_volume), so the dock does not wait for a busy tick
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		if (m_image_active && !m_image_paused) {
+			m_image_paused_ns = os_gettime_ns();
+			m_image_paused = true;
+		}
+	}
+	end_shuttle();
+	m_commands.set_latest("pause", "yes");
+}
+void ObsMpvSource::stop() {
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		m_image_active = false;
+		m_image_capture_armed = false;
+	}
+	m_commands.drop_pending("time-pos");
+	m_seek_request_ns = 0;
+	end_shuttle();
+	set_transport_mute(false);
+	m_history_reset = true;
+	if (!m_mpv) {
+		// Released: nothing would receive the command, so just forget the
+		// item that was to be resumed
+		MpvLock lock(m_mpv_mutex);
+		if (m_resume_index >= 0 && (size_t)m_resume_index < m_playlist.size())
+			m_playlist[m_resume_index].last_seek_pos = 0.0;
+		m_resume_index = -1;
+	}
+	m_commands.command({"stop"});
+}
+void ObsMpvSource::seek(double s) {
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		if (m_image_active) {
+			uint64_t now = m_image_paused ? m_image_paused_ns : os_gettime_ns();
+			m_image_start_ns = now - (uint64_t)(std::clamp(s, 0.0, m_image_duration_ns / 1e9) * 1e9);
+			return;
+		}
+	}
+	if (seek_released(s, false)) return;
+	m_seek_request_ns = os_gettime_ns(); // A superseded seek is timed from its replacement
+	m_seek_restarted = false;
+	m_history_reset = true;
+	m_commands.set_latest("time-pos", s);
+}
+void ObsMpvSource::seek_relative(double s) {
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		if (m_image_active) {
+			uint64_t now = m_image_paused ? m_image_paused_ns : os_gettime_ns();
+			m_image_start_ns = now - (uint64_t)(std::clamp(image_elapsed() + s, 0.0, m_image_duration_ns / 1e9) * 1e9);
+			return;
+		}
+	}
+	if (seek_released(s, true)) return;
+	// A relative seek command, not a time-pos computed here: repeated jumps
+	// add up in mpv without reading the position back
+	char arg[32];
+	format_seconds(s, arg, sizeof(arg));
+	m_seek_request_ns = os_gettime_ns();
+	m_seek_restarted = false;
+	m_history_reset = true;
+	m_commands.command({"seek", arg, "relative"});
+}
+
+bool ObsMpvSource::seek_released(double s, bool relative) {
+	// Without mpv (released or not created yet) the seek moves the position
+	// the released item resumes at instead
+	if (m_mpv) return false;
+	MpvLock lock(m_mpv_mutex);
+	if (m_mpv) return false;
+	if (m_resume_index >= 0 && (size_t)m_resume_index < m_playlist.size()) {
+		double &pos = m_playlist[m_resume_index].last_seek_pos;
+		pos = std::max(relative ? pos + s : s, 0.0);
+	}
+	return true;
+}
+
+void ObsMpvSource::frame_step(int direction) {
+	MpvLock lock(m_mpv_mutex);
+	if (m_image_active || !m_mpv || m_resume_index >= 0) return;
+	check_history_reset();
+	end_shuttle();
+	m_commands.set_latest("pause", "yes");
+	set_transport_mute(true);
+	if (direction < 0) step_back();
+	else step_forward();
+}
+
+void ObsMpvSource::shuttle(int direction) {
+	MpvLock lock(m_mpv_mutex);
+	if (direction == 0) {
+		pause();
+		return;
+	}
+	if (m_image_active || (m_resume_index >= 0 && direction < 0)) {
+		if (direction > 0) play();
+		return;
+	}
+	if (!ensure_mpv()) return;
+	check_history_reset();
+
+	// Each press in the same direction doubles the speed, up to 8x; the
+	// other direction starts over at 1x
+	int speed = m_shuttle;
+	if (direction > 0) {
+		speed = speed > 0 ? std::min(speed * 2, 8) : 1;
+		leave_history();
+		m_shuttle = speed;
+		m_commands.set_latest("speed", (double)speed);
+		set_transport_mute(speed > 2);
+		if (m_resume_index >= 0) resume_released(false);
+		else m_commands.set_latest("pause", "no");
+	} else {
+		speed = speed < 0 ? std::max(speed * 2, -8) : -1;
+		if (m_shuttle >= 0) {
+			m_commands.set_latest("speed", 1.0);
+			m_shuttle_frames = 0.0;
+		}
+		m_shuttle = speed;
+		m_commands.set_latest("pause", "yes");
+		set_transport_mute(true);
+	}
+}
+
+void ObsMpvSource::end_shuttle() {
+	if (m_shuttle.exchange(0) != 0) m_commands.set_latest("speed", 1.0);
+}
+
+void ObsMpvSource::set_transport_mute(bool mute) {
+	if (m_transport_muted.exchange(mute) != mute) m_commands.set_latest("mute", mute ? "yes" : "no");
+}
+
+double ObsMpvSource::frame_duration() {
+	double fps = 0.0;
+	if (m_mpv) mpv_get_property(m_mpv, "container-fps", MPV_FORMAT_DOUBLE, &fps);
+	return fps > 1.0 ? 1.0 / fps : 1.0 / 30.0;
+}
+
+void ObsMpvSource::check_history_reset() {
+	// Seeks and loads don't take the mpv lock, so they only flag the history
+	if (!m_history_reset.exchange(false)) return;
+	m_history.clear();
+	m_history_prepend = m_history_skip = false;
+}
+
+void ObsMpvSource::set_history_limit(int mb) {
+	MpvLock lock(m_mpv_mutex);
+	m_history.set_limit_mb(mb);
+	m_history_enabled = m_history.enabled();
+}
+
+bool ObsMpvSource::record_history_frame(const uint8_t *data, uint32_t width, uint32_t height, double time) {
+	// False for a frame that must not replace the cached one on screen,
+	// such as one still in flight from before reverse shuttle paused mpv
+	if (!m_history.enabled() || m_image_active) return true;
+	if (m_history_skip) {
+		m_history_skip = false;
+		return true;
+	}
+	if (m_history.browsing() && !m_history_prepend) return false;
+
+	if (m_history_prepend) {
+		m_history_prepend = false;
+		m_history.push_front(data, width, height, time);
+		return true;
+	}
+	// Starts over after a jump that wasn't flagged in time, or a loop
+	const MpvFrameHistory::Frame *newest = m_history.newest();
+	if (newest && (time < newest->time || time > newest->time + 1.0)) m_history.clear();
+	m_history.push_back(data, width, height, time);
+	return true;
+}
+
+void ObsMpvSource::output_history_frame(const MpvFrameHistory::Frame &frame) {
+	output_video_frame(const_cast<uint8_t *>(frame.data.data()), frame.width, frame.height, os_gettime_ns());
+}
+
+bool ObsMpvSource::step_back() {
+	// False only at the first frame
+	if (m_history_prepend) return true; // The previous step is still being decoded
+	if (const MpvFrameHistory::Frame *frame = m_history.back()) {
+		output_history_frame(*frame);
+		m_stats.steps_cached.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	const MpvFrameHistory::Frame *oldest = m_history.oldest();
+	if (!oldest) {
+		// Nothing kept: mpv steps back itself, from the previous keyframe
+		m_commands.command({"frame-back-step"});
+		m_history_prepend = m_history.enabled();
+	} else {
+		// An exact seek shows the first frame at or after its target, so aim
+		// half a frame past the one before the oldest
+		double duration = frame_duration();
+		if (oldest->time < duration / 2) return false;
+		char arg[32];
+		format_seconds(std::max(oldest->time - 1.5 * duration, 0.0), arg, sizeof(arg));
+		m_commands.command({"seek", arg, "absolute+exact"});
+		m_history_prepend = true;
+	}
+	m_stats.steps_decoded.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void ObsMpvSource::step_forward() {
+	if (m_history_prepend) return;
+	if (const MpvFrameHistory::Frame *frame = m_history.forward()) {
+		output_history_frame(*frame);
+		m_stats.steps_cached.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	leave_history();
+	m_commands.command({"frame-step"});
+	m_stats.steps_decoded.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ObsMpvSource::leave_history() {
+	// mpv carries on from the frame on screen, not from the one it last
+	// decoded; the frames after it are decoded again anyway
+	if (m_history_prepend) {
+		m_history.clear(); // The seek for it already went out
+		m_history_prepend = false;
+		return;
+	}
+	if (m_history.browsing()) {
+		char arg[32];
+		format_seconds(m_history.cursor()->time, arg, sizeof(arg));
+		m_commands.command({"seek", arg, "absolute+exact"});
+		m_history_skip = true; // That seek renders the cursor frame again
+	}
+	m_history.anchor_at_cursor();
+}
+
+void ObsMpvSource::tick_shuttle(float seconds) {
+	// Reverse: step back at the shuttle speed, showing only the last frame
+	// due this tick. Past the oldest kept frame each step waits for its
+	// decode, and the time spent waiting is not made up afterwards.
+	m_shuttle_frames += seconds * -m_shuttle / frame_duration();
+	const MpvFrameHistory::Frame *frame = nullptr;
+	while (m_shuttle_frames >= 1.0 && !m_history_prepend) {
+		const MpvFrameHistory::Frame *prev = m_history.back();
+		if (!prev) break;
+		frame = prev;
+		m_shuttle_frames -= 1.0;
+		m_stats.steps_cached.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (frame) output_history_frame(*frame);
+
+	if (m_shuttle_frames >= 1.0 && !m_history_prepend) {
+		// Without a history every step is an mpv frame-back-step; one at a time
+		if (!m_history.enabled() && m_commands.stats().in_flight > 0) return;
+		if (!step_back()) {
+			end_shuttle(); // Reached the start
+			return;
+		}
+		m_shuttle_frames -= 1.0;
+	}
+	m_shuttle_frames = std::min(m_shuttle_frames, 1.0);
+}
+double ObsMpvSource::get_time_pos() {
+	MpvLock lock(m_mpv_mutex);
+	{
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		if (m_image_active) return image_elapsed();
+	}
+	if (m_history.browsing()) return m_history.cursor()->time;
+	double v=0; if (m_mpv) mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &v); return v;
+}
+double ObsMpvSource::get_duration() {
+	MpvLock lock(m_mpv_mutex);
+	if (m_image_active) {
+		std::lock_guard<std::mutex> lock(m_image_mutex);
+		return m_image_duration_ns / 1e9;
+	}
+	double v=0; if (m_mpv) mpv_get_property(m_mpv, "duration", MPV_FORMAT_DOUBLE, &v); return v;
+}
 
 double ObsMpvSource::get_time_remaining() {
     double d = get_duration();
@@ -694,6 +2173,7 @@ double ObsMpvSource::get_time_remaining() {
 }
 
 double ObsMpvSource::get_playlist_time_remaining() {
+    MpvLock lock(m_mpv_mutex);
     double current_rem = get_time_remaining();
     double following = 0.0;
     if (m_current_index >= 0) {
@@ -707,12 +2187,9 @@ double ObsMpvSource::get_playlist_time_remaining() {
 int ObsMpvSource::get_current_index() { return m_current_index; }
 
 void ObsMpvSource::set_sub_style(const SubStyle& style) {
+    MpvLock lock(m_mpv_mutex);
     m_sub_style = style;
-    mpv_set_option_string(m_mpv, "sub-font", style.font.c_str());
-    mpv_set_option_string(m_mpv, "sub-color", style.color.c_str());
-    mpv_set_option_string(m_mpv, "sub-shadow-color", style.shadow_color.c_str());
-    mpv_set_option_string(m_mpv, "sub-font-size", std::to_string(style.font_size).c_str());
-    mpv_set_option_string(m_mpv, "sub-shadow-offset", std::to_string(style.shadow_offset).c_str());
+    apply_sub_style();
     
     // Save to OBS settings
     obs_data_t *settings = obs_source_get_settings(m_source);
@@ -724,32 +2201,83 @@ void ObsMpvSource::set_sub_style(const SubStyle& style) {
     obs_data_release(settings);
 }
 
+void ObsMpvSource::apply_sub_style() {
+    if (!m_mpv) return;
+    mpv_set_option_string(m_mpv, "sub-font", m_sub_style.font.c_str());
+    mpv_set_option_string(m_mpv, "sub-color", m_sub_style.color.c_str());
+    mpv_set_option_string(m_mpv, "sub-shadow-color", m_sub_style.shadow_color.c_str());
+    mpv_set_option_string(m_mpv, "sub-font-size", std::to_string(m_sub_style.font_size).c_str());
+    mpv_set_option_string(m_mpv, "sub-shadow-offset", std::to_string(m_sub_style.shadow_offset).c_str());
+}
+
+void ObsMpvSource::apply_audio_output_format() {
+	// Pinning the AO format to OBS's keeps the stream identical across playlist
+	// items; mpv's resampler does the conversion instead of OBS. The audio
+	// thread picks the new format up from audio-out-params once mpv has
+	// reconfigured (AUDIO_RECONFIG), not before: PCM already queued is still
+	// in the old one.
+	const char *layouts = MPV_AUDIO_CHANNEL_LAYOUTS;
+	std::string rate = "0"; // 0 = file's native rate
+	obs_audio_info oai;
+	if (m_audio_match_obs && obs_get_audio_info(&oai)) {
+		if (const char *name = mpv_audio_layout_name(oai.speakers)) layouts = name;
+		rate = std::to_string(oai.samples_per_sec);
+	}
+	if (!m_mpv) return; // Applied when mpv is created
+	mpv_set_option_string(m_mpv, "audio-samplerate", rate.c_str());
+	mpv_set_option_string(m_mpv, "audio-channels", layouts);
+
+	static const struct {
+		const char *filter_size;
+		const char *phase_shift;
+	} quality[] = {{"8", "8"}, {"16", "10"}, {"32", "12"}};
+	int q = std::clamp(m_resample_quality, 0, 2);
+	mpv_set_option_string(m_mpv, "audio-resample-filter-size", quality[q].filter_size);
+	mpv_set_option_string(m_mpv, "audio-resample-phase-shift", quality[q].phase_shift);
+}
+
 ObsMpvSource::SubStyle ObsMpvSource::get_sub_style() const { return m_sub_style; }
 
-double ObsMpvSource::get_volume() { double v=100; mpv_get_property(m_mpv, "volume", MPV_FORMAT_DOUBLE, &v); return v; }
-void ObsMpvSource::set_volume(double vol) { mpv_set_property(m_mpv, "volume", MPV_FORMAT_DOUBLE, &vol); }
+double ObsMpvSource::get_volume() { MpvLock lock(m_mpv_mutex); double v=100; if (m_mpv) mpv_get_property(m_mpv, "volume", MPV_FORMAT_DOUBLE, &v); return v; }
+void ObsMpvSource::set_volume(double vol) { m_commands.set_latest("volume", vol); }
 
 bool ObsMpvSource::is_playing() {
+    MpvLock lock(m_mpv_mutex);
+    if (m_image_active) {
+        std::lock_guard<std::mutex> lock(m_image_mutex);
+        return !m_image_paused;
+    }
+    if (!m_mpv) return false;
     int p=1;
     mpv_get_property(m_mpv, "pause", MPV_FORMAT_FLAG, &p);
     return p==0 && !is_idle();
 }
 
 bool ObsMpvSource::is_paused(){
+    MpvLock lock(m_mpv_mutex);
+    if (m_image_active) {
+        std::lock_guard<std::mutex> lock(m_image_mutex);
+        return m_image_paused;
+    }
+    if (!m_mpv) return false;
     int p=0;
     mpv_get_property(m_mpv, "pause", MPV_FORMAT_FLAG, &p);
     return p==1 && !is_idle();
 }
 
 bool ObsMpvSource::is_idle(){
+    MpvLock lock(m_mpv_mutex);
+    if (m_image_active) return false; // mpv is stopped while a cached image is up
+    if (!m_mpv) return true; // Not created yet: nothing loaded
     int idle=0;
     mpv_get_property(m_mpv, "idle-active", MPV_FORMAT_FLAG, &idle);
     return idle==1;
 }
 
 std::vector<ObsMpvSource::MpvTrack> ObsMpvSource::get_tracks(const char *type) {	std::vector<MpvTrack> res;
+	MpvLock lock(m_mpv_mutex);
 	mpv_node node;
-	if (mpv_get_property(m_mpv, "track-list", MPV_FORMAT_NODE, &node) == 0) {
+	if (m_mpv && mpv_get_property(m_mpv, "track-list", MPV_FORMAT_NODE, &node) == 0) {
 		if (node.format == MPV_FORMAT_NODE_ARRAY) {
 			for (int i = 0; i < node.u.list->num; i++) {
 				mpv_node *tr = &node.u.list->values[i];
@@ -786,8 +2314,36 @@ void ObsMpvSource::obs_save(void *data, obs_data_t *settings) {
 	static_cast<ObsMpvSource*>(data)->save_playlist(settings);
 }
 
+static void save_tracks(obs_data_t *obj, const char *name, const std::vector<ObsMpvSource::MpvTrack> &tracks) {
+	obs_data_array_t *array = obs_data_array_create();
+	for (const auto &t : tracks) {
+		obs_data_t *track = obs_data_create();
+		obs_data_set_int(track, "id", t.id);
+		obs_data_set_string(track, "name", t.name.c_str());
+		obs_data_array_push_back(array, track);
+		obs_data_release(track);
+	}
+	obs_data_set_array(obj, name, array);
+	obs_data_array_release(array);
+}
+
+static std::vector<ObsMpvSource::MpvTrack> load_tracks(obs_data_t *obj, const char *name) {
+	std::vector<ObsMpvSource::MpvTrack> tracks;
+	obs_data_array_t *array = obs_data_get_array(obj, name);
+	if (!array) return tracks;
+	for (size_t i = 0; i < obs_data_array_count(array); i++) {
+		obs_data_t *track = obs_data_array_item(array, i);
+		tracks.push_back({(int)obs_data_get_int(track, "id"), obs_data_get_string(track, "name"), false});
+		obs_data_release(track);
+	}
+	obs_data_array_release(array);
+	return tracks;
+}
+
 void ObsMpvSource::save_playlist(obs_data_t *settings) {
-	obs_data_set_bool(settings, "auto_obs_fps", m_auto_obs_fps);
+	MpvLock lock(m_mpv_mutex);
+	obs_data_set_int(settings, "fps_mode", m_fps_mode);
+	obs_data_set_bool(settings, "auto_obs_fps", m_fps_mode == FPS_MODE_RESET_OBS);
 	obs_data_array_t *array = obs_data_array_create();
 	for (const auto& item : m_playlist) {
 		obs_data_t *obj = obs_data_create();
@@ -803,6 +2359,20 @@ void ObsMpvSource::save_playlist(obs_data_t *settings) {
 		obs_data_set_double(obj, "fade_in", item.fade_in);
 		obs_data_set_bool(obj, "fade_out_enabled", item.fade_out_enabled);
 		obs_data_set_double(obj, "fade_out", item.fade_out);
+		if (item.is_image) obs_data_set_double(obj, "image_duration", item.image_duration);
+		obs_data_set_bool(obj, "preload", item.preload);
+		if (item.loudness_measured) {
+			obs_data_set_bool(obj, "loudness_measured", true);
+			obs_data_set_double(obj, "loudness_lufs", item.loudness_lufs);
+			obs_data_set_double(obj, "true_peak_db", item.true_peak_db);
+		}
+		if (item.probed) {
+			obs_data_set_bool(obj, "probed", true);
+			obs_data_set_double(obj, "fps", item.fps);
+			obs_data_set_int(obj, "audio_channels", item.audio_channels);
+			save_tracks(obj, "audio_tracks", item.audio_tracks);
+			save_tracks(obj, "sub_tracks", item.sub_tracks);
+		}
 		obs_data_array_push_back(array, obj);
 		obs_data_release(obj);
 	}
@@ -813,6 +2383,7 @@ void ObsMpvSource::save_playlist(obs_data_t *settings) {
 void ObsMpvSource::load_playlist(obs_data_t *settings) {
 	obs_data_array_t *array = obs_data_get_array(settings, "playlist");
 	if (!array) return;
+	MpvLock lock(m_mpv_mutex);
 	m_playlist.clear();
 	size_t count = obs_data_array_count(array);
 	for (size_t i = 0; i < count; i++) {
@@ -830,47 +2401,192 @@ void ObsMpvSource::load_playlist(obs_data_t *settings) {
 		item.fade_in = obs_data_get_double(obj, "fade_in");
 		item.fade_out_enabled = obs_data_get_bool(obj, "fade_out_enabled");
 		item.fade_out = obs_data_get_double(obj, "fade_out");
+		item.preload = obs_data_get_bool(obj, "preload");
+
+		if (is_image_path(item.path)) {
+			// Nothing to probe: no tracks, no frame rate, our own duration
+			item.is_image = true;
+			item.image_duration = obs_data_has_user_value(obj, "image_duration")
+						      ? obs_data_get_double(obj, "image_duration")
+						      : m_default_image_duration;
+			item.duration = item.image_duration;
+			m_playlist.push_back(item);
+			obs_data_release(obj);
+			continue;
+		}
 
-		mpv_handle *probe_mpv = mpv_create();
-		if (probe_mpv) {
-			mpv_set_option_string(probe_mpv, "vo", "null");
-			mpv_set_option_string(probe_mpv, "ao", "null");
-			mpv_initialize(probe_mpv);
-			const char *cmd[] = {"loadfile", item.path.c_str(), nullptr};
-			mpv_command(probe_mpv, cmd);
-			while (true) {
-				mpv_event *event = mpv_wait_event(probe_mpv, 0.5);
-				if (event->event_id == MPV_EVENT_FILE_LOADED) {
-					mpv_get_property(probe_mpv, "container-fps", MPV_FORMAT_DOUBLE, &item.fps);
-					int64_t ch = 0;
-					mpv_get_property(probe_mpv, "audio-params/channel-count", MPV_FORMAT_INT64, &ch);
-					item.audio_channels = (int)ch;
-					mpv_node node;
-					if (mpv_get_property(probe_mpv, "track-list", MPV_FORMAT_NODE, &node) == 0) {
-						if (node.format == MPV_FORMAT_NODE_ARRAY) {
-							for (int k = 0; k < node.u.list->num; k++) {
-								mpv_node *tr = &node.u.list->values[k];
-								const char *t=nullptr, *l=nullptr; int64_t tid=-1;
-								for (int j=0; j<tr->u.list->num; j++) {
-									const char *key = tr->u.list->keys[j]; mpv_node *v = &tr->u.list->values[j];
-									if (!strcmp(key, "type")) t=v->u.string;
-									else if (!strcmp(key, "id")) tid=v->u.int64;
-									else if (!strcmp(key, "lang")) l=v->u.string;
-								}
-								if (t && !strcmp(t, "audio")) item.audio_tracks.push_back({(int)tid, l ? l : std::to_string(tid), false});
-								if (t && !strcmp(t, "sub")) item.sub_tracks.push_back({(int)tid, l ? l : std::to_string(tid), false});
-							}
-						}
-						mpv_free_node_contents(&node);
-					}
-					break;
-				}
-				if (event->event_id == MPV_EVENT_NONE || event->event_id == MPV_EVENT_SHUTDOWN) break;
-			}
-			mpv_terminate_destroy(probe_mpv);
+		// Items saved before metadata was stored with the playlist get probed
+		// on the worker pool; nothing here opens a file
+		LoadJob job;
+		job.path = item.path;
+		job.preload = item.preload;
+		item.loudness_measured = obs_data_get_bool(obj, "loudness_measured");
+		if (item.loudness_measured) {
+			item.loudness_lufs = obs_data_get_double(obj, "loudness_lufs");
+			item.true_peak_db = obs_data_get_double(obj, "true_peak_db");
+		}
+		item.probed = obs_data_get_bool(obj, "probed");
+		if (item.probed) {
+			item.fps = obs_data_get_double(obj, "fps");
+			item.audio_channels = (int)obs_data_get_int(obj, "audio_channels");
+			item.audio_tracks = load_tracks(obj, "audio_tracks");
+			item.sub_tracks = load_tracks(obj, "sub_tracks");
+		} else {
+			job.probe = true;
 		}
+		if (job.preload) job.priority = MpvTaskPriority::Prefetch;
+		if (job.probe || job.preload) queue_load(job);
 		m_playlist.push_back(item);
 		obs_data_release(obj);
 	}
 	obs_data_array_release(array);
 }
+
+void ObsMpvSource::StatCounters::add_render(uint64_t ns, bool new_frame) {
+	frames_rendered.fetch_add(1, std::memory_order_relaxed);
+	if (!new_frame) frames_repeated.fetch_add(1, std::memory_order_relaxed);
+	render_ns_total.fetch_add(ns, std::memory_order_relaxed);
+	render_ns_last.store(ns, std::memory_order_relaxed);
+	// Single writer (video tick), so a plain compare is enough
+	if (ns > render_ns_max.load(std::memory_order_relaxed)) render_ns_max.store(ns, std::memory_order_relaxed);
+}
+
+void ObsMpvSource::StatCounters::add_seek(uint64_t ns) {
+	seek_ns_last.store(ns, std::memory_order_relaxed);
+	seek_ns_total.fetch_add(ns, std::memory_order_relaxed);
+	seek_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ObsMpvSource::StatCounters::add_probe(uint64_t ns) {
+	probe_ns_last.store(ns, std::memory_order_relaxed);
+	probe_ns_total.fetch_add(ns, std::memory_order_relaxed);
+	probe_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+ObsMpvSource::Stats ObsMpvSource::get_stats() {
+	MpvLock lock(m_mpv_mutex);
+	Stats st;
+	auto rd = [](const std::atomic<uint64_t> &v) { return v.load(std::memory_order_relaxed); };
+
+	st.frames_rendered = rd(m_stats.frames_rendered);
+	st.frames_repeated = rd(m_stats.frames_repeated);
+	st.render_ms_last = rd(m_stats.render_ns_last) / 1e6;
+	st.render_ms_max = rd(m_stats.render_ns_max) / 1e6;
+	if (st.frames_rendered > 0) st.render_ms_avg = rd(m_stats.render_ns_total) / 1e6 / (double)st.frames_rendered;
+
+	uint32_t rate = m_sample_rate;
+	int chans = m_channels;
+	if (rate > 0 && chans > 0) st.audio_queue_ms = rd(m_stats.audio_queue_bytes) * 1000.0 / ((double)rate * chans * sizeof(float));
+	st.audio_underruns = rd(m_stats.audio_underruns);
+
+	st.probe_ms_last = rd(m_stats.probe_ns_last) / 1e6;
+	uint64_t probes = rd(m_stats.probe_count);
+	if (probes > 0) st.probe_ms_avg = rd(m_stats.probe_ns_total) / 1e6 / (double)probes;
+
+	st.seek_ms_last = rd(m_stats.seek_ns_last) / 1e6;
+	st.seeks = rd(m_stats.seek_count);
+	if (st.seeks > 0) st.seek_ms_avg = rd(m_stats.seek_ns_total) / 1e6 / (double)st.seeks;
+
+	st.frame_queue_depth = rd(m_stats.frame_queue_depth);
+	st.frame_queue_capacity = m_frame_queue_capacity.load(std::memory_order_relaxed);
+	st.frame_spikes = rd(m_stats.frame_spikes);
+	st.spikes_absorbed = rd(m_stats.spikes_absorbed);
+	st.frames_unchanged = rd(m_stats.frames_unchanged);
+	MpvClipCache::Stats clips = m_clip_cache.stats();
+	st.clip_cache_hits = clips.hits;
+	st.clip_cache_misses = clips.misses;
+	st.clip_cache_mb = clips.bytes / 1048576.0;
+	st.video_width = m_native_width;
+	st.video_height = m_native_height;
+	st.output_width = m_width;
+	st.output_height = m_height;
+	st.mpv_releases = rd(m_stats.mpv_releases);
+	st.live_instances = mpv_budget_live();
+	st.instance_limit = mpv_budget_limit();
+	if (m_current_index >= 0 && (size_t)m_current_index < m_playlist.size()) {
+		const PlaylistItem &item = m_playlist[m_current_index];
+		st.loudness_measured = item.loudness_measured;
+		st.loudness_lufs = item.loudness_lufs;
+		st.true_peak_db = item.true_peak_db;
+	}
+	st.auto_gain_db = 20.0 * std::log10(m_audio_gain.load());
+	MpvCommandQueue::Stats commands = m_commands.stats();
+	st.commands_sent = commands.sent;
+	st.commands_coalesced = commands.coalesced;
+	st.commands_failed = commands.failed;
+	st.commands_in_flight = commands.in_flight;
+	st.history_frames = m_history.size();
+	st.history_mb = m_history.bytes() / 1048576.0;
+	st.steps_cached = rd(m_stats.steps_cached);
+	st.steps_decoded = rd(m_stats.steps_decoded);
+	st.shuttle = m_shuttle;
+	st.mpv_live = m_mpv != nullptr;
+	if (!m_mpv) {
+		st.hwdec_current = "no";
+		return st;
+	}
+	char *hwdec_current = mpv_get_property_string(m_mpv, "hwdec-current");
+	st.hwdec_current = hwdec_current ? hwdec_current : "no";
+	mpv_free(hwdec_current);
+
+	// Not hot-path: straight from mpv
+	int64_t vo_drops = 0, dec_drops = 0;
+	mpv_get_property(m_mpv, "frame-drop-count", MPV_FORMAT_INT64, &vo_drops);
+	mpv_get_property(m_mpv, "decoder-frame-drop-count", MPV_FORMAT_INT64, &dec_drops);
+	st.frames_dropped = vo_drops + dec_drops + (int64_t)rd(m_stats.frames_superseded);
+	mpv_get_property(m_mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &st.decoder_fps);
+	mpv_get_property(m_mpv, "container-fps", MPV_FORMAT_DOUBLE, &st.container_fps);
+	double avsync = 0.0;
+	if (mpv_get_property(m_mpv, "avsync", MPV_FORMAT_DOUBLE, &avsync) >= 0) st.av_offset_ms = avsync * 1000.0;
+	return st;
+}
+
+void ObsMpvSource::proc_get_stats(void *data, calldata_t *cd) {
+	Stats st = static_cast<ObsMpvSource*>(data)->get_stats();
+	calldata_set_int(cd, "frames_rendered", (long long)st.frames_rendered);
+	calldata_set_int(cd, "frames_dropped", st.frames_dropped);
+	calldata_set_int(cd, "frames_repeated", (long long)st.frames_repeated);
+	calldata_set_float(cd, "render_ms_last", st.render_ms_last);
+	calldata_set_float(cd, "render_ms_avg", st.render_ms_avg);
+	calldata_set_float(cd, "render_ms_max", st.render_ms_max);
+	calldata_set_float(cd, "decoder_fps", st.decoder_fps);
+	calldata_set_float(cd, "container_fps", st.container_fps);
+	calldata_set_float(cd, "audio_queue_ms", st.audio_queue_ms);
+	calldata_set_int(cd, "audio_underruns", (long long)st.audio_underruns);
+	calldata_set_float(cd, "av_offset_ms", st.av_offset_ms);
+	calldata_set_float(cd, "probe_ms_last", st.probe_ms_last);
+	calldata_set_float(cd, "probe_ms_avg", st.probe_ms_avg);
+	calldata_set_int(cd, "frame_queue_depth", (long long)st.frame_queue_depth);
+	calldata_set_int(cd, "frame_queue_capacity", (long long)st.frame_queue_capacity);
+	calldata_set_int(cd, "frame_spikes", (long long)st.frame_spikes);
+	calldata_set_int(cd, "spikes_absorbed", (long long)st.spikes_absorbed);
+	calldata_set_int(cd, "frames_unchanged", (long long)st.frames_unchanged);
+	calldata_set_int(cd, "clip_cache_hits", (long long)st.clip_cache_hits);
+	calldata_set_int(cd, "clip_cache_misses", (long long)st.clip_cache_misses);
+	calldata_set_float(cd, "clip_cache_mb", st.clip_cache_mb);
+	calldata_set_string(cd, "hwdec_current", st.hwdec_current.c_str());
+	calldata_set_int(cd, "video_width", st.video_width);
+	calldata_set_int(cd, "video_height", st.video_height);
+	calldata_set_int(cd, "output_width", st.output_width);
+	calldata_set_int(cd, "output_height", st.output_height);
+	calldata_set_bool(cd, "mpv_live", st.mpv_live);
+	calldata_set_int(cd, "mpv_releases", (long long)st.mpv_releases);
+	calldata_set_int(cd, "live_instances", st.live_instances);
+	calldata_set_int(cd, "instance_limit", st.instance_limit);
+	calldata_set_bool(cd, "loudness_measured", st.loudness_measured);
+	calldata_set_float(cd, "loudness_lufs", st.loudness_lufs);
+	calldata_set_float(cd, "true_peak_db", st.true_peak_db);
+	calldata_set_float(cd, "auto_gain_db", st.auto_gain_db);
+	calldata_set_int(cd, "commands_sent", (long long)st.commands_sent);
+	calldata_set_int(cd, "commands_coalesced", (long long)st.commands_coalesced);
+	calldata_set_int(cd, "commands_failed", (long long)st.commands_failed);
+	calldata_set_int(cd, "commands_in_flight", st.commands_in_flight);
+	calldata_set_float(cd, "seek_ms_last", st.seek_ms_last);
+	calldata_set_float(cd, "seek_ms_avg", st.seek_ms_avg);
+	calldata_set_int(cd, "seeks", (long long)st.seeks);
+	calldata_set_int(cd, "history_frames", (long long)st.history_frames);
+	calldata_set_float(cd, "history_mb", st.history_mb);
+	calldata_set_int(cd, "steps_cached", (long long)st.steps_cached);
+	calldata_set_int(cd, "steps_decoded", (long long)st.steps_decoded);
+	calldata_set_int(cd, "shuttle", st.shuttle);
+}
@@ -3,12 +3,24 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <obs-module.h>
 #include <mpv/client.h>
 #include <mpv/render.h>
+#include "mpv-audio-pipe.hpp"
+#include "mpv-clip-cache.hpp"
+#include "mpv-command-queue.hpp"
+#include "mpv-frame-history.hpp"
+#include "mpv-instance-budget.hpp"
+#include "mpv-loudness.hpp"
+#include "mpv-video.hpp"
+#include "mpv-worker-pool.hpp"
 
 class MpvControlDock;
 
@@ -22,6 +34,7 @@ public:
     static void *obs_create(obs_data_t *settings, obs_source_t *source);
     static void obs_destroy(void *data);
     static void obs_save(void *data, obs_data_t *settings);
+    static void obs_get_defaults(obs_data_t *settings);
     static obs_properties_t *obs_get_properties(void *data);
     static void obs_properties_update(void *data, obs_data_t *settings);
     static uint32_t obs_get_width(void *data);
@@ -30,6 +43,8 @@ public:
     
     static void obs_activate(void *data);
     static void obs_deactivate(void *data);
+    static void obs_show(void *data);
+    static void obs_hide(void *data);
 
     // OBS Media Callbacks
     static void obs_media_play_pause(void *data, bool pause);
@@ -63,12 +78,25 @@ public:
         double fade_in = 0.0;
         bool fade_out_enabled = false;
         double fade_out = 0.0;
+
+        // Still images are shown for image_duration seconds (see start_image_item)
+        bool is_image = false;
+        double image_duration = 5.0;
+
+        bool preload = false; // Keep the file in memory (see MpvClipCache)
         
-        // Metadata
+        // Metadata; saved with the playlist once probed, so loading it again
+        // does not have to open every file
+        bool probed = false;
         std::vector<MpvTrack> audio_tracks;
         std::vector<MpvTrack> sub_tracks;
         double fps = 0.0;
         int audio_channels = 0;
+
+        // EBU R128 measurement (see mpv-loudness.hpp), saved like the metadata
+        bool loudness_measured = false;
+        double loudness_lufs = 0.0;
+        double true_peak_db = 0.0;
         
         // Saved state
         double last_seek_pos = 0.0;
@@ -102,7 +130,9 @@ public:
     
     std::vector<MpvTrack> get_tracks(const char *type);
     
-    // Playlist Management
+    // Playlist Management. The playlist is guarded by m_mpv_mutex (the tick
+    // applies probe and loudness results to it), so callers get copies and
+    // change items through playlist_edit_item, never through a pointer.
     void playlist_add(const std::string& path);
     void playlist_add_multiple(const std::vector<std::string>& paths);
     void playlist_remove(int index);
@@ -111,14 +141,23 @@ public:
     void playlist_play_with_fade(int index, double fade_sec);
     void playlist_restart_with_fade(double fade_sec);
     void playlist_next();
-    PlaylistItem* playlist_get_item(int index);
+    bool playlist_get_item(int index, PlaylistItem &item);
+    std::vector<PlaylistItem> playlist_items();
+    bool playlist_edit_item(int index, const std::function<void(PlaylistItem &)> &edit);
+    void playlist_set_preload(int index, bool enabled);
     int playlist_count();
     
     void set_auto_obs_fps(bool enabled);
     bool get_auto_obs_fps();
+    void set_fps_mode(int mode); // FpsMode
+    int get_fps_mode();
+    void set_seek_mode(int mode); // SeekMode
+    int get_seek_mode();
 
     void save_playlist(obs_data_t *settings);
     void load_playlist(obs_data_t *settings);
+    bool loads_pending(); // Background probes/preloads not yet applied
+    uint32_t playlist_revision() const { return m_playlist_revision; } // Bumped when probe results land
     
     // Metadata Probing
     struct FileMetadata {
@@ -130,20 +169,216 @@ public:
     };
     FileMetadata probe_file(const std::string& path);
 
+    // Performance statistics snapshot (see get_stats / "get_stats" proc)
+    struct Stats {
+        uint64_t frames_rendered = 0;
+        uint64_t frames_repeated = 0; // Redraws without a new decoded frame
+        int64_t frames_dropped = 0;   // mpv VO + decoder drops + frames superseded in the queue
+        double render_ms_last = 0.0;
+        double render_ms_avg = 0.0;
+        double render_ms_max = 0.0;
+        double decoder_fps = 0.0;
+        double container_fps = 0.0;
+        double audio_queue_ms = 0.0;
+        uint64_t audio_underruns = 0;
+        double av_offset_ms = 0.0;
+        double probe_ms_last = 0.0;
+        double probe_ms_avg = 0.0;
+        uint64_t frame_queue_depth = 0;    // Rendered frames waiting for output
+        uint64_t frame_queue_capacity = 0; // 0 when the queue is off
+        uint64_t frame_spikes = 0;         // Frames mpv delivered with less lead than usual
+        uint64_t spikes_absorbed = 0;      // ...of which still made their display time
+        uint64_t frames_unchanged = 0;     // Identical frames not rendered or not output again
+        uint64_t clip_cache_hits = 0;      // Preloaded items played from memory
+        uint64_t clip_cache_misses = 0;    // ...or (re)loaded first
+        double clip_cache_mb = 0.0;
+        std::string hwdec_current;         // What mpv actually uses ("no" when software)
+        uint32_t video_width = 0;          // Native size of the current file
+        uint32_t video_height = 0;
+        uint32_t output_width = 0;         // Size actually rendered and output
+        uint32_t output_height = 0;
+        bool mpv_live = false;             // False until first use and after an idle release
+        uint64_t mpv_releases = 0;
+        int live_instances = 0;            // All sources (see mpv-instance-budget.hpp)
+        int instance_limit = 0;
+        bool loudness_measured = false;    // Current item
+        double loudness_lufs = 0.0;
+        double true_peak_db = 0.0;
+        double auto_gain_db = 0.0;         // Applied now (0 when auto gain is off)
+        uint64_t commands_sent = 0;        // Control commands (see mpv-command-queue.hpp)
+        uint64_t commands_coalesced = 0;
+        uint64_t commands_failed = 0;
+        int commands_in_flight = 0;
+        double seek_ms_last = 0.0;         // Seek request to its first new frame
+        double seek_ms_avg = 0.0;
+        uint64_t seeks = 0;
+        uint64_t history_frames = 0;       // Frame step history (see mpv-frame-history.hpp)
+        double history_mb = 0.0;
+        uint64_t steps_cached = 0;         // Frame steps shown from the history
+        uint64_t steps_decoded = 0;        // ...or decoded by mpv
+        int shuttle = 0;                   // See shuttle()
+    };
+    Stats get_stats();
+
+    // Output levels for the dock's meter, linear (1.0 = full scale). Peaks
+    // fall back at 20 dB/s, RMS is averaged over about 300 ms, and both drop
+    // to zero once no audio has gone out for a moment (paused, stopped).
+    struct AudioLevels {
+        int channels = 0;
+        float peak[MAX_AUDIO_CHANNELS] = {};
+        float rms[MAX_AUDIO_CHANNELS] = {};
+    };
+    AudioLevels get_audio_levels() const;
+
 private:
     obs_source_t *m_source;
-    mpv_handle *m_mpv;
-    mpv_render_context *m_mpv_render_ctx;
+
+    // Created on first show/activation/play rather than with the source, so
+    // loading a scene collection costs nothing per source (see ensure_mpv),
+    // and released again after idling (see check_idle). The controls and the
+    // video tick hold m_mpv_mutex, so mpv cannot go away under them; the
+    // render itself only holds m_render_mutex (see tick_render).
+    std::atomic<mpv_handle *> m_mpv{nullptr};
+    mpv_render_context *m_mpv_render_ctx = nullptr;
+    std::recursive_mutex m_mpv_mutex;
+    using MpvLock = std::lock_guard<std::recursive_mutex>;
+    bool ensure_mpv();
+    bool create_mpv(obs_data_t *settings);
+    void destroy_mpv();
+    void apply_sub_style();
+
+    // Idle release: stopped, or paused on no visible/active scene, for
+    // m_idle_release_ns (or asked to by the instance budget). The playlist
+    // stays; a paused item resumes where it was when mpv comes back.
+    MpvBudgetEntry m_budget;
+    uint64_t m_idle_release_ns = 0; // 0 = only when the budget needs room
+    uint64_t m_next_idle_check_ns = 0;
+    std::atomic<bool> m_active{false};
+    bool m_mpv_wanted = false;  // Refused by the budget; retried from the tick
+    int m_pending_play = -1;    // Item requested while refused
+    int m_resume_index = -1;    // Item that was paused when mpv was released
+    void check_idle();
+    void release_mpv();
+    void resume_released(bool paused);
+    bool seek_released(double seconds, bool relative);
+
+    // Work left to the plugin worker pool: probing items that have no
+    // metadata yet (restored or just added) and reading preload items into
+    // the clip cache. The tick copies probe results into m_playlist.
+    struct LoadJob {
+        std::string path;
+        bool probe = false;
+        bool preload = false;
+        MpvTaskPriority priority = MpvTaskPriority::Background;
+    };
+    std::mutex m_load_mutex; // Guards m_load_jobs and the results
+    std::vector<LoadJob> m_load_jobs; // Queued or running
+    std::vector<std::pair<std::string, FileMetadata>> m_probe_results;
+    std::atomic<bool> m_probe_results_ready{false};
+    std::atomic<uint32_t> m_playlist_revision{0};
+    MpvTaskGroup m_load_tasks;
+    void queue_load(const LoadJob &job);
+    void run_load_job(const LoadJob &job); // On a pool worker
+    void apply_probe_results();
+    static bool probe_with(mpv_handle *probe_mpv, const std::string &path, FileMetadata &meta);
     
-    std::vector<PlaylistItem> m_playlist;
+    std::vector<PlaylistItem> m_playlist; // Guarded by m_mpv_mutex
     int m_current_index = -1;
     SubStyle m_sub_style;
     
-    uint32_t m_width;
-    uint32_t m_height;
+    std::atomic<uint32_t> m_width;  // Output size, set on the render side
+    std::atomic<uint32_t> m_height;
     std::string m_current_file_path;
     
-    std::vector<uint8_t> m_sw_buffer;
+    std::vector<uint8_t> m_sw_buffer; // Tick only; destroy_mpv() frees it under m_render_mutex
+
+    bool refresh_video_size();
+    bool tick_control(float seconds);
+    void tick_render();
+
+    // Output size: native, or scaled down into a box (fixed, or the largest
+    // bounding box of the scene items showing this source)
+    enum RenderSizeMode { RENDER_SIZE_NATIVE = 0, RENDER_SIZE_FIXED = 1, RENDER_SIZE_MATCH_BOUNDS = 2 };
+    std::atomic<int> m_render_size_mode{RENDER_SIZE_NATIVE};
+    std::atomic<uint32_t> m_render_box_width{0};
+    std::atomic<uint32_t> m_render_box_height{0};
+    std::atomic<uint32_t> m_native_width{0};
+    std::atomic<uint32_t> m_native_height{0};
+    uint64_t m_next_box_check_ns = 0; // Video tick only
+    void fit_render_size(uint32_t native_w, uint32_t native_h, uint32_t &out_w, uint32_t &out_h);
+    void update_render_box();
+    void update_render_size(obs_data_t *settings);
+
+    // Still-image items: mpv decodes the file once, the first rendered frame is
+    // cached (BGRA at output size) and mpv is stopped. Showing the item again
+    // only re-outputs the cached frame; a timer moves on to the next item.
+    struct CachedImage {
+        std::vector<uint8_t> data;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t native_width = 0; // To tell whether the render size still matches
+        uint32_t native_height = 0;
+        uint64_t last_used = 0;
+    };
+    std::mutex m_image_mutex; // Guards everything below except the atomics
+    std::unordered_map<std::string, CachedImage> m_image_cache;
+    size_t m_image_cache_bytes = 0;
+    uint64_t m_image_cache_uses = 0;
+    int m_image_cache_mb = 256;
+    double m_default_image_duration = 5.0;
+    std::atomic<bool> m_image_active{false};
+    std::atomic<bool> m_image_capture{false}; // Next output frame goes into the cache
+    bool m_image_capture_armed = false;       // Loading through mpv; capture once loaded
+    bool m_image_output_pending = false;      // Cached frame still to be output
+    bool m_image_paused = false;
+    std::string m_image_path;
+    uint64_t m_image_start_ns = 0;
+    uint64_t m_image_paused_ns = 0;
+    uint64_t m_image_duration_ns = 0;
+    static bool is_image_path(const std::string &path);
+    void update_image_settings(obs_data_t *settings);
+    void start_image_item(const PlaylistItem &item);
+    void tick_image();
+    void capture_image_frame(const uint8_t *data, uint32_t width, uint32_t height);
+    void evict_cached_images();
+    double image_elapsed(); // Caller holds m_image_mutex
+    bool render_sw(uint8_t *dst, bool new_frame, bool block);
+    void render_discard();
+    void output_video_frame(uint8_t *data, uint32_t width, uint32_t height, uint64_t timestamp);
+    std::atomic<uint64_t> m_last_output_hash{0}; // 0 = nothing output yet
+    bool skip_repeated_frame();
+
+    // Look-ahead queue of rendered frames. With a depth > 0 a worker renders
+    // ahead of display time and the video tick releases frames as they come
+    // due; with 0 the tick renders directly (m_sw_buffer).
+    struct QueuedFrame {
+        std::vector<uint8_t> data;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t timestamp = 0; // Display time (os_gettime_ns clock)
+        bool new_frame = false;  // Not a redraw of the previous one
+        double time = 0.0;       // Its pts, for the frame step history
+    };
+    int m_frame_queue_depth = 0;  // Requested depth (setting "frame_queue")
+    int m_frame_queue_mb = 128;   // Memory cap per source (setting "frame_queue_mb")
+    std::atomic<size_t> m_frame_queue_capacity{0}; // Depth after applying the memory cap
+    std::atomic<uint64_t> m_frame_queue_lookahead_ns{0};
+    std::deque<QueuedFrame> m_frame_queue;
+    std::vector<std::vector<uint8_t>> m_frame_pool;
+    std::mutex m_frame_queue_mutex; // Guards the queue, pool, m_render_pending and m_stop_render_thread
+    std::condition_variable m_frame_queue_cv;
+    bool m_render_pending = false;
+    bool m_stop_render_thread = false;
+    std::mutex m_render_mutex;      // One mpv_render_context_render caller at a time
+    std::atomic<bool> m_render_worker_active{false};
+    std::thread m_render_thread;
+    void update_frame_queue(int depth, int cap_mb);
+    void stop_render_worker();
+    void apply_video_timing();
+    void flush_frame_queue();
+    void render_thread_func();
+    void render_queued_frame();
+    void drain_frame_queue(float seconds);
     
     std::deque<uint8_t> m_audio_queue;
     std::mutex m_audio_mutex;
@@ -151,29 +386,154 @@ private:
     std::atomic<bool> m_events_available;
     std::atomic<bool> m_redraw_needed;
     std::atomic<bool> m_is_loading;
-    bool m_auto_obs_fps = false;
+
+    // Items whose frame rate differs from OBS's
+    enum FpsMode { FPS_MODE_OFF = 0, FPS_MODE_RESET_OBS = 1, FPS_MODE_CONFORM = 2, FPS_MODE_CONFORM_BLEND = 3 };
+    std::atomic<int> m_fps_mode{FPS_MODE_OFF};
+    MpvCanvasClock m_canvas_clock; // Video tick only, like the rest of the conform state
+    std::vector<uint8_t> m_prev_frame; // Last output frame (blend mode)
+    std::vector<uint8_t> m_blend_buffer;
+    uint64_t m_prev_frame_ts = 0;
+    static int fps_mode_setting(obs_data_t *settings);
+    uint64_t next_frame_display_time(int64_t *lead_us);
+    void output_conformed_frame(uint8_t *data, uint32_t width, uint32_t height, uint64_t display_ts);
+    void reset_conform();
+
+    // Fast seeks land on the keyframe at or before the target (mpv
+    // hr-seek=no), exact ones decode up to the target frame (hr-seek=yes).
+    // Latency runs from the seek request to the first new frame rendered
+    // after mpv reports playback restarted.
+    enum SeekMode { SEEK_MODE_FAST = 0, SEEK_MODE_EXACT = 1 };
+    std::atomic<int> m_seek_mode{SEEK_MODE_EXACT};
+    std::atomic<uint64_t> m_seek_request_ns{0}; // 0 = no seek pending
+    std::atomic<bool> m_seek_restarted{false};
+    void note_seek_frame(uint64_t now_ns);
+
+    // Frame stepping and JKL shuttle. Every new frame that goes out is kept
+    // in m_history (guarded by the mpv lock), so stepping backward shows
+    // frames from memory instead of mpv decoding again from the previous
+    // keyframe. Past the oldest one an exact seek decodes the frame before
+    // it, which is added in front. Reverse shuttle steps back through the
+    // history from the tick. Audio is muted while stepping, in reverse and
+    // above 2x; mpv pitch-corrects up to that.
+    MpvFrameHistory m_history;
+    std::atomic<int> m_shuttle{0};           // 0, or speed: 1, 2, 4, 8 forward, -1 ... -8 reverse
+    double m_shuttle_frames = 0.0;           // Reverse steps due, tick only
+    bool m_history_prepend = false;          // The next new frame goes in front of the history
+    bool m_history_skip = false;             // The next new frame is already the cursor frame
+    std::atomic<bool> m_history_reset{false}; // Set by seeks and loads without the mpv lock
+    std::atomic<bool> m_transport_muted{false};
+    std::atomic<bool> m_history_enabled{false}; // Read by the render worker
+    void set_history_limit(int mb);
+    bool record_history_frame(const uint8_t *data, uint32_t width, uint32_t height, double time);
+    void output_history_frame(const MpvFrameHistory::Frame &frame);
+    bool step_back();
+    void step_forward();
+    void leave_history();
+    void check_history_reset();
+    void tick_shuttle(float seconds);
+    void end_shuttle();
+    void set_transport_mute(bool mute);
+    double frame_duration();
     
     // Activation behaviors
     bool m_restart_on_activate = false; // "Restart playback when source becomes active"
     bool m_pause_on_deactivate = true; // Typically desirable to pause when hidden
 
-    // Audio via FIFO
-    std::string m_fifo_path;
-#ifdef _WIN32
-    void *m_pipe_handle; // HANDLE is void*
-#endif
+    // What to do with video while the source is on no visible scene
+    enum HiddenVideoMode { HIDDEN_VIDEO_RENDER = 0, HIDDEN_VIDEO_SKIP_RENDER = 1, HIDDEN_VIDEO_DISABLE_TRACK = 2 };
+    std::atomic<int> m_hidden_video_mode{HIDDEN_VIDEO_RENDER}; // Also read by the audio thread
+    std::atomic<bool> m_showing{false};
+    bool m_video_track_disabled = false;
+    void update_video_track();
+
+    // Audio via anonymous pipe (mpv "pcm" AO writes into it); created with mpv
+    std::unique_ptr<MpvAudioPipe> m_audio_pipe;
+
+    MpvClipCache m_clip_cache;
+
+    // Every control command goes out through here (see mpv-command-queue.hpp)
+    MpvCommandQueue m_commands;
+
+    // Decoder tuning (hwdec, threads, demuxer cache, frame dropping); the
+    // defaults can be saved plugin-wide from any source's properties
+    void apply_decoder_settings(obs_data_t *settings);
+    static bool save_decoder_defaults(obs_properties_t *props, obs_property_t *property, void *data);
+
+    // Auto gain: items are measured in the background (MpvLoudnessAnalyzer)
+    // while enabled, and the current item is scaled to the target loudness
+    bool m_auto_gain = false;
+    double m_target_lufs = -23.0;
+    uint32_t m_loudness_revision = 0;
+    void apply_loudness_settings(obs_data_t *settings);
+    void request_loudness();
+    void apply_loudness_results();
+    void update_auto_gain();
+
 	std::atomic<bool> m_stop_audio_thread;
 	std::atomic<bool> m_flush_audio_buffer;
 	std::atomic<bool> m_av_sync_started;
+	std::atomic<bool> m_has_video{true}; // The current item has a video track selected
+	void start_av_sync(uint64_t timestamp);
+	bool video_frames_expected() const;
+	void update_has_video();
 	std::atomic<uint32_t> m_sample_rate;
 	std::atomic<int> m_channels;
+	std::atomic<bool> m_audio_planar{false};
+	bool m_audio_match_obs = false; // Pin mpv's output rate/layout to OBS's
+	int m_resample_quality = 1;      // 0 = fast, 1 = mpv default, 2 = high
 	std::thread m_audio_thread;
+	std::vector<uint8_t> m_audio_out_buf;   // audio thread only
+	std::vector<float> m_audio_planar_buf;  // audio thread only
+	std::atomic<float> m_audio_gain{1.0f};  // Auto gain of the current item, linear
+	// Written by the audio thread per chunk, read by get_audio_levels()
+	std::atomic<float> m_level_peak[MAX_AUDIO_CHANNELS] = {};
+	std::atomic<float> m_level_ms[MAX_AUDIO_CHANNELS] = {}; // Mean square
+	std::atomic<int> m_level_channels{0};
+	std::atomic<uint64_t> m_level_time_ns{0};
+	void update_levels(const float *samples, uint32_t frames, int channels, uint32_t rate);
     void audio_thread_func();
+    void output_queued_audio(size_t chunk_size);
+    void apply_audio_output_format();
     
     // A/V Sync
     std::atomic<uint64_t> m_total_audio_frames;
     std::atomic<uint64_t> m_audio_start_ts;
 
+    // Hot-path counters; relaxed atomics only, aggregated in get_stats()
+    struct StatCounters {
+        std::atomic<uint64_t> frames_rendered{0};
+        std::atomic<uint64_t> frames_repeated{0};
+        std::atomic<uint64_t> render_ns_total{0};
+        std::atomic<uint64_t> render_ns_last{0};
+        std::atomic<uint64_t> render_ns_max{0};
+        std::atomic<uint64_t> audio_queue_bytes{0};
+        std::atomic<uint64_t> audio_underruns{0};
+        std::atomic<uint64_t> probe_ns_last{0};
+        std::atomic<uint64_t> probe_ns_total{0};
+        std::atomic<uint64_t> probe_count{0};
+        std::atomic<uint64_t> frame_queue_depth{0};
+        std::atomic<uint64_t> frames_superseded{0};
+        std::atomic<uint64_t> frame_spikes{0};
+        std::atomic<uint64_t> spikes_absorbed{0};
+        std::atomic<uint64_t> frames_unchanged{0};
+        std::atomic<uint64_t> mpv_releases{0};
+        std::atomic<uint64_t> seek_ns_last{0};
+        std::atomic<uint64_t> seek_ns_total{0};
+        std::atomic<uint64_t> seek_count{0};
+        std::atomic<uint64_t> steps_cached{0};
+        std::atomic<uint64_t> steps_decoded{0};
+
+        void add_render(uint64_t ns, bool new_frame);
+        void add_probe(uint64_t ns);
+        void add_seek(uint64_t ns);
+    };
+    StatCounters m_stats;
+    std::atomic<bool> m_core_idle{true};
+    bool m_audio_underrun = false; // audio thread only, edge-triggers the counter
+
+    static void proc_get_stats(void *data, calldata_t *cd);
+
     void handle_mpv_events();
     
     static void on_mpv_wakeup(void *ctx);
@@ -185,4 +545,8 @@ private:
     void pause();
     void stop();
     void seek(double seconds);
+    void seek_relative(double seconds);
+    void frame_step(int direction); // One frame back (< 0) or forward, pauses
+    void shuttle(int direction);    // J (< 0), K (0) or L (> 0)
+    int get_shuttle() const { return m_shuttle; }
 };
@@ -19,6 +19,12 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-module.h>
 #include <plugin-support.h>
 #include "mpv-dock.hpp"
+#include "mpv-instance-budget.hpp"
+#include "mpv-loudness.hpp"
+#include "mpv-seek-preview.hpp"
+#include "mpv-thumbnails.hpp"
+#include "mpv-worker-pool.hpp"
+#include "mpv-trace.hpp"
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,9 +39,40 @@ OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
 extern struct obs_source_info mpv_source_info;
 
+// Global trace control, so scripts and websocket clients can capture a timeline too
+static void proc_trace_start(void *, calldata_t *)
+{
+	mpv_trace_start();
+}
+
+static void proc_trace_dump(void *, calldata_t *cd)
+{
+	const char *path = calldata_string(cd, "path");
+	calldata_set_bool(cd, "success", path && *path && mpv_trace_dump(path));
+}
+
+static void proc_get_instances(void *, calldata_t *cd)
+{
+	calldata_set_int(cd, "live", mpv_budget_live());
+	calldata_set_int(cd, "limit", mpv_budget_limit());
+}
+
+static void proc_set_instance_limit(void *, calldata_t *cd)
+{
+	mpv_budget_set_limit((int)calldata_int(cd, "limit"));
+	mpv_budget_save();
+}
+
 bool obs_module_load(void)
 {
+	mpv_budget_load();
 	obs_register_source(&mpv_source_info);
+
+	proc_handler_t *ph = obs_get_proc_handler();
+	proc_handler_add(ph, "void mpv_trace_start()", proc_trace_start, nullptr);
+	proc_handler_add(ph, "void mpv_trace_dump(in string path, out bool success)", proc_trace_dump, nullptr);
+	proc_handler_add(ph, "void mpv_get_instances(out int live, out int limit)", proc_get_instances, nullptr);
+	proc_handler_add(ph, "void mpv_set_instance_limit(in int limit)", proc_set_instance_limit, nullptr);
     
     // Register Dock using correct API
     obs_frontend_add_dock_by_id("mpv_controls", "MPV Controls & Playlist", new MpvControlDock());
@@ -46,5 +83,9 @@ bool obs_module_load(void)
 
 void obs_module_unload(void)
 {
+	MpvThumbnailCache::instance().shutdown();
+	MpvSeekPreview::instance().shutdown();
+	MpvLoudnessAnalyzer::instance().shutdown();
+	MpvWorkerPool::instance().shutdown();
 	obs_log(LOG_INFO, "plugin unloaded");
 }